@@ -0,0 +1,91 @@
+#pragma once
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tanu::cfg::bench {
+
+    // --name=value options given after the benchmark name
+    using BenchArgs = std::map<std::string, std::string>;
+    using BenchFn = void (*)(const BenchArgs&);
+
+    std::map<std::string, BenchFn>& registry();
+
+    struct BenchRegistrar {
+        BenchRegistrar(const char* name, BenchFn fn) {
+            registry()[name] = fn;
+        }
+    };
+
+    int64_t arg_int(const BenchArgs& args, const std::string& name, int64_t default_value);
+    std::string arg_str(const BenchArgs& args, const std::string& name, const std::string& default_value);
+
+    // points NEKOKAN_CONF_DIR at a scratch directory and returns the
+    // group/app directory JSONConfig{group, app} will read from
+    std::filesystem::path prepare_conf_dir(const std::string& group, const std::string& app);
+
+    struct ChildRun {
+        double seconds;
+        // peak RSS of the child above what it inherited at fork
+        double peak_rss_mb;
+        // whatever the measured function returned
+        double reported;
+    };
+
+    // runs fn in a forked child, as a fresh process would, and times it
+    ChildRun run_in_child(const std::function<double()>& fn);
+
+    inline double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // adds one measurement of the running benchmark to the machine-readable
+    // results (--out=path). case_name tells its configurations apart, e.g.
+    // "size_mb=50/index"; metric and case together stay stable across runs
+    // so results can be compared against a baseline.
+    void record(const std::string& case_name, const std::string& metric, double value, const std::string& unit);
+
+    struct Latency {
+        double mean_ns;
+        double p50_ns;
+        double p99_ns;
+    };
+
+    // per-call latency of fn over batches of batch_size calls; timing
+    // single calls would mostly measure the clock
+    template<typename Fn>
+    Latency measure_latency(int64_t batches, int batch_size, Fn&& fn) {
+        std::vector<double> samples;
+        samples.reserve(batches);
+        double sum = 0;
+        for(int64_t b = 0; b < batches; b++) {
+            const auto t0 = std::chrono::steady_clock::now();
+            for(int i = 0; i < batch_size; i++) {
+                fn();
+            }
+            samples.push_back(seconds_since(t0) / batch_size * 1e9);
+            sum += samples.back();
+        }
+        std::sort(samples.begin(), samples.end());
+        return Latency {sum / samples.size(), samples[samples.size() / 2], samples[samples.size() * 99 / 100]};
+    }
+
+    // records mean, p50 and p99 of l under case_name
+    void record_latency(const std::string& case_name, const Latency& l);
+
+}
+
+#define TANU_BENCH(name) \
+    static void bench_##name(const tanu::cfg::bench::BenchArgs& args); \
+    static tanu::cfg::bench::BenchRegistrar bench_registrar_##name(#name, bench_##name); \
+    static void bench_##name([[maybe_unused]] const tanu::cfg::bench::BenchArgs& args)
+
+#endif
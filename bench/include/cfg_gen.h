@@ -0,0 +1,34 @@
+#pragma once
+#ifndef __CFG_GEN_H__
+#define __CFG_GEN_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include "bench.h"
+
+namespace tanu::cfg::bench {
+
+    struct GenOptions {
+        size_t target_bytes = 1 << 20;
+        // nesting of objects below each top-level section
+        int depth = 3;
+        // members per object
+        int fanout = 8;
+        int array_len = 16;
+        int key_len = 12;
+        uint64_t seed = 42;
+    };
+
+    // writes a synthetic config of roughly target_bytes: top-level sections
+    // of nested objects whose leaves mix ints, doubles, strings, bools and
+    // numeric/string arrays. returns the size actually written.
+    size_t generate_config(const std::filesystem::path& out, const GenOptions& opts);
+
+    // defaults overridden by --depth, --fanout, --array_len, --key_len and
+    // --seed
+    GenOptions gen_options(const BenchArgs& args);
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// filling a settings struct key by key through the getters against one
+// JSONConfig::bind() call with compile-time hashed paths
+
+namespace {
+
+    struct ServerSettings {
+        int port;
+        int workers;
+        double timeout;
+        double backoff;
+        string host;
+        string log_level;
+        vector<int> retry_codes;
+        vector<double> weights;
+        vector<string> upstreams;
+    };
+
+}
+
+template<>
+struct tanu::cfg::CfgBinding<ServerSettings> {
+    static constexpr auto fields = make_tuple(
+        cfg_field("server/port", &ServerSettings::port),
+        cfg_field("server/workers", &ServerSettings::workers),
+        cfg_field("server/timeout", &ServerSettings::timeout),
+        cfg_field("server/backoff", &ServerSettings::backoff),
+        cfg_field("server/host", &ServerSettings::host),
+        cfg_field("logging/level", &ServerSettings::log_level),
+        cfg_field("server/retry_codes", &ServerSettings::retry_codes),
+        cfg_field("routing/weights", &ServerSettings::weights),
+        cfg_field("routing/upstreams", &ServerSettings::upstreams));
+};
+
+TANU_BENCH(bind) {
+    const int64_t iterations = arg_int(args, "iterations", 200000);
+    const auto dir = prepare_conf_dir("bench", "bind");
+    ofstream(dir / "cfg.json") << R"({
+        "server": {"port": 8080, "workers": 16, "timeout": 2.5, "backoff": 0.25,
+                   "host": "0.0.0.0", "retry_codes": [502, 503, 504]},
+        "logging": {"level": "info"},
+        "routing": {"weights": [0.5, 0.3, 0.2], "upstreams": ["a.internal", "b.internal", "c.internal"]}
+    })";
+    JSONConfig cfg {"bench", "bind"};
+    cfg.load("cfg.json");
+
+    size_t sink = 0;
+    auto t0 = chrono::steady_clock::now();
+    for(int64_t i = 0; i < iterations; i++) {
+        ServerSettings s;
+        s.port = cfg.get_as_int("server/port");
+        s.workers = cfg.get_as_int("server/workers");
+        s.timeout = cfg.get_as_double("server/timeout");
+        s.backoff = cfg.get_as_double("server/backoff");
+        s.host = cfg.get_as_str("server/host");
+        s.log_level = cfg.get_as_str("logging/level");
+        s.retry_codes = cfg.get_as_int_vec("server/retry_codes");
+        s.weights = cfg.get_as_double_vec("routing/weights");
+        s.upstreams = cfg.get_as_str_vec("routing/upstreams");
+        sink += s.upstreams.size() + s.port;
+    }
+    const double getters_ns = seconds_since(t0) / iterations * 1e9;
+
+    t0 = chrono::steady_clock::now();
+    for(int64_t i = 0; i < iterations; i++) {
+        const ServerSettings s = cfg.bind<ServerSettings>();
+        sink += s.upstreams.size() + s.port;
+    }
+    const double bind_ns = seconds_since(t0) / iterations * 1e9;
+
+    cout << format("{:>10} {:>14}", "path", "ns/struct") << endl;
+    cout << format("{:>10} {:>14.1f}", "getters", getters_ns) << endl;
+    cout << format("{:>10} {:>14.1f}", "bind", bind_ns) << endl;
+    record("getters", "struct_fill", getters_ns, "ns");
+    record("bind", "struct_fill", bind_ns, "ns");
+    if(sink == 42) {
+        cout << endl;
+    }
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <format>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_batch.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// service boot: bringing up `configs` configs of size_mb each by calling
+// load() on them one after another, against cfg_load_all() on 1, 2, 4, ...
+// up to `threads` threads. each run is a fresh forked process.
+
+TANU_BENCH(boot) {
+    const int configs = static_cast<int>(arg_int(args, "configs", 12));
+    const int64_t size_mb = arg_int(args, "size_mb", 5);
+    const int max_threads = static_cast<int>(arg_int(args, "threads", 8));
+    const int runs = static_cast<int>(arg_int(args, "runs", 3));
+    const auto dir = prepare_conf_dir("bench", "boot");
+
+    vector<CfgLoadRequest> requests;
+    GenOptions opts = gen_options(args);
+    opts.target_bytes = static_cast<size_t>(size_mb) << 20;
+    for(int i = 0; i < configs; i++) {
+        const string file_name = format("cfg_{}.json", i);
+        opts.seed++;
+        generate_config(dir / file_name, opts);
+        requests.push_back(CfgLoadRequest {"bench", "boot", file_name});
+    }
+
+    cout << format("{:>8} {:>8} {:>12} {:>10}", "mode", "threads", "boot_ms", "speedup") << endl;
+    auto report = [&](const string& mode, int threads, auto&& boot, double serial_ms) {
+        double total_s = 0;
+        for(int r = 0; r < runs; r++) {
+            total_s += run_in_child([&] {
+                boot();
+                return 0.0;
+            }).seconds;
+        }
+        const double ms = total_s / runs * 1000;
+        cout << format("{:>8} {:>8} {:>12.2f} {:>10.2f}", mode, threads, ms, serial_ms > 0 ? serial_ms / ms : 1.0) << endl;
+        record(format("configs={}/size_mb={}/{}/threads={}", configs, size_mb, mode, threads), "boot", ms, "ms");
+        return ms;
+    };
+
+    const double serial_ms = report("serial", 1, [&] {
+        vector<unique_ptr<JSONConfig>> cfgs;
+        for(const CfgLoadRequest& req : requests) {
+            cfgs.push_back(make_unique<JSONConfig>(req.group, req.app));
+            cfgs.back()->load(req.file);
+        }
+    }, 0);
+    for(int threads = 1; threads <= max_threads; threads *= 2) {
+        report("batch", threads, [&] {
+            cfg_load_all(requests, threads);
+        }, serial_ms);
+    }
+    for(const CfgLoadRequest& req : requests) {
+        filesystem::remove(dir / req.file);
+    }
+}
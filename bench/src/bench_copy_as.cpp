@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "cpptanu_cfg/cfg_numeric.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// exporting a large double array as floats: the get_as_double_vec + loop
+// callers write today against copy_as<float>, copy_as_aligned<float> and
+// the bare conversion kernels at each level the cpu has. latencies are per
+// whole array.
+
+TANU_BENCH(copy_as) {
+    const string sizes = arg_str(args, "sizes", "100000,1000000");
+    const int64_t batches = arg_int(args, "batches", 200);
+    const auto dir = prepare_conf_dir("bench", "copy_as");
+
+    mt19937_64 rng(arg_int(args, "seed", 42));
+    uniform_real_distribution<double> dist(-1e6, 1e6);
+    json doc;
+    stringstream ss(sizes);
+    string len;
+    while(getline(ss, len, ',')) {
+        vector<double> values(stoull(len));
+        for(double& v : values) {
+            v = dist(rng);
+        }
+        doc[len] = values;
+    }
+    ofstream(dir / "features.json") << doc.dump();
+    JSONConfig cfg {"bench", "copy_as"};
+    cfg.load("features.json");
+
+    cout << format("simd level: {}", cfg_simd_name(cfg_simd_level())) << endl;
+    cout << format("{:>10} {:>22} {:>12} {:>12} {:>10}", "len", "method", "mean us", "p99 us", "GB/s") << endl;
+    ss = stringstream(sizes);
+    while(getline(ss, len, ',')) {
+        const size_t n = stoull(len);
+        vector<float> out(n);
+        float sink = 0;
+        auto report = [&](const string& method, const Latency& l) {
+            // bytes read plus bytes written
+            const double gbps = n * (sizeof(double) + sizeof(float)) / l.mean_ns;
+            cout << format("{:>10} {:>22} {:>12.1f} {:>12.1f} {:>10.2f}", n, method, l.mean_ns / 1000, l.p99_ns / 1000, gbps) << endl;
+            const string case_name = format("len={}/{}", n, method);
+            record_latency(case_name, l);
+            record(case_name, "bandwidth", gbps, "GB/s");
+        };
+
+        report("double_vec_loop", measure_latency(batches, 1, [&] {
+            const vector<double> v = cfg.get_as_double_vec(len);
+            for(size_t i = 0; i < v.size(); i++) {
+                out[i] = static_cast<float>(v[i]);
+            }
+            sink += out[n / 2];
+        }));
+        report("copy_as", measure_latency(batches, 1, [&] {
+            cfg.copy_as<float>(len, span<float>(out));
+            sink += out[n / 2];
+        }));
+        report("copy_as_aligned", measure_latency(batches, 1, [&] {
+            const CfgAlignedArray<float> a = cfg.copy_as_aligned<float>(len);
+            sink += a[n / 2];
+        }));
+        const span<const double> src = cfg.get_as_double_span(len);
+        for(int l = 0; l <= static_cast<int>(cfg_simd_level()); l++) {
+            const CfgSimd level = static_cast<CfgSimd>(l);
+            report(format("kernel_{}", cfg_simd_name(level)), measure_latency(batches, 1, [&] {
+                cfg_convert(src, out.data(), level);
+                sink += out[n / 2];
+            }));
+        }
+        if(sink == 42.0f) {
+            cout << endl;
+        }
+    }
+    filesystem::remove(dir / "features.json");
+}
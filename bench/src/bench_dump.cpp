@@ -0,0 +1,55 @@
+#include <iostream>
+#include <format>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// dump_cfg() and dump_flattened_view() against streaming the same output to
+// a file descriptor with dump(). the config is loaded once; each dump runs
+// in a forked child so its peak RSS above the loaded process is its own.
+
+TANU_BENCH(dump) {
+    const string sizes = arg_str(args, "sizes", "1,50");
+    const auto dir = prepare_conf_dir("bench", "dump");
+
+    cout << format("{:>8} {:>10} {:>10} {:>10} {:>12}", "size_mb", "view", "method", "dump_ms", "peak_rss_mb") << endl;
+    stringstream ss(sizes);
+    string size_mb;
+    while(getline(ss, size_mb, ',')) {
+        GenOptions opts = gen_options(args);
+        opts.target_bytes = stoull(size_mb) << 20;
+        const string file_name = format("cfg_{}mb.json", size_mb);
+        generate_config(dir / file_name, opts);
+        JSONConfig cfg {"bench", "dump"};
+        cfg.load(file_name);
+        const int null_fd = open("/dev/null", O_WRONLY);
+
+        for(const bool flattened : {false, true}) {
+            const string view = flattened ? "flattened" : "document";
+            const ChildRun whole = run_in_child([&] {
+                const optional<string> text = flattened ? cfg.dump_flattened_view() : cfg.dump_cfg();
+                return static_cast<double>(write(null_fd, text->data(), text->size()));
+            });
+            const ChildRun streamed = run_in_child([&] {
+                cfg.dump(null_fd, CfgDumpOptions {.flattened = flattened});
+                return 0.0;
+            });
+            for(const auto& [method, run] : {pair {"string", whole}, pair {"stream", streamed}}) {
+                cout << format("{:>8} {:>10} {:>10} {:>10.2f} {:>12.1f}", size_mb, view, method, run.seconds * 1000, run.peak_rss_mb) << endl;
+                const string case_name = format("size_mb={}/{}/{}", size_mb, view, method);
+                record(case_name, "dump", run.seconds * 1000, "ms");
+                record(case_name, "peak_rss", run.peak_rss_mb, "MB");
+            }
+        }
+        close(null_fd);
+        filesystem::remove(dir / file_name);
+    }
+}
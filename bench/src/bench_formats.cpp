@@ -0,0 +1,59 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <sstream>
+#include <string>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_format.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// JSONConfig::load() of the same generated config in every CfgFormat. the
+// binary files are converted from the json one with cfg_encode(); each load
+// runs in a forked child and is timed end to end.
+
+TANU_BENCH(formats) {
+    const string sizes = arg_str(args, "sizes", "1,50");
+    const int runs = static_cast<int>(arg_int(args, "runs", 3));
+    const auto dir = prepare_conf_dir("bench", "formats");
+
+    cout << format("{:>8} {:>8} {:>10} {:>10} {:>12} {:>12}", "size_mb", "format", "file_mb", "load_ms", "json_MB/s", "file_MB/s") << endl;
+    stringstream ss(sizes);
+    string size_mb;
+    while(getline(ss, size_mb, ',')) {
+        GenOptions opts = gen_options(args);
+        opts.target_bytes = stoull(size_mb) << 20;
+        const string json_name = format("cfg_{}mb.json", size_mb);
+        const double json_mb = generate_config(dir / json_name, opts) / 1048576.0;
+        const json doc = json::parse(ifstream(dir / json_name));
+
+        for(const CfgFormat fmt : {CfgFormat::Json, CfgFormat::Cbor, CfgFormat::MsgPack, CfgFormat::Bson}) {
+            string file_name = json_name;
+            if(fmt != CfgFormat::Json) {
+                file_name = format("cfg_{}mb.{}", size_mb, cfg_format_name(fmt));
+                const vector<uint8_t> bytes = cfg_encode(doc, fmt);
+                ofstream(dir / file_name, ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            }
+            const double file_mb = filesystem::file_size(dir / file_name) / 1048576.0;
+            double total_s = 0;
+            for(int r = 0; r < runs; r++) {
+                total_s += run_in_child([&] {
+                    JSONConfig cfg {"bench", "formats"};
+                    cfg.load(file_name);
+                    return 0.0;
+                }).seconds;
+            }
+            const double s = total_s / runs;
+            cout << format("{:>8} {:>8} {:>10.1f} {:>10.2f} {:>12.1f} {:>12.1f}", size_mb, cfg_format_name(fmt), file_mb, s * 1000, json_mb / s, file_mb / s) << endl;
+            const string case_name = format("size_mb={}/{}", size_mb, cfg_format_name(fmt));
+            record(case_name, "load", s * 1000, "ms");
+            record(case_name, "throughput", json_mb / s, "MB/s");
+            record(case_name, "file_size", file_mb, "MB");
+            filesystem::remove(dir / file_name);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// single-thread getter latency: scalar getters over the leaves of a
+// generated config, and vector getters against the span views by array size
+
+namespace {
+
+    struct LeafKeys {
+        vector<string> ints;
+        vector<string> doubles;
+        vector<string> strs;
+    };
+
+    void collect_leaves(const json& node, const string& path, LeafKeys& keys, size_t limit) {
+        for(const auto& [name, value] : node.items()) {
+            const string key = path + "/" + name;
+            if(value.is_object()) {
+                collect_leaves(value, key, keys, limit);
+            } else if(value.is_number_integer() && keys.ints.size() < limit) {
+                keys.ints.push_back(key);
+            } else if(value.is_number_float() && keys.doubles.size() < limit) {
+                keys.doubles.push_back(key);
+            } else if(value.is_string() && keys.strs.size() < limit) {
+                keys.strs.push_back(key);
+            }
+        }
+    }
+
+}
+
+TANU_BENCH(getters) {
+    const int64_t batches = arg_int(args, "batches", 20000);
+    const size_t n_keys = static_cast<size_t>(arg_int(args, "keys", 4096));
+    const string array_sizes = arg_str(args, "array_sizes", "1,16,256,4096");
+    const auto dir = prepare_conf_dir("bench", "getters");
+
+    GenOptions opts = gen_options(args);
+    opts.target_bytes = static_cast<size_t>(arg_int(args, "size_mb", 4)) << 20;
+    generate_config(dir / "scalars.json", opts);
+    JSONConfig cfg {"bench", "getters"};
+    cfg.load("scalars.json");
+    LeafKeys keys;
+    collect_leaves(cfg.snapshot()->index.to_json(), "", keys, n_keys);
+
+    // cycles through the keys so the lookups are not all served by one line
+    int64_t sink = 0;
+    auto cycling = [&](const vector<string>& pool, auto&& get) {
+        return [&pool, get, &sink, k = size_t {0}]() mutable {
+            sink += get(pool[k]);
+            k = k + 1 == pool.size() ? 0 : k + 1;
+        };
+    };
+
+    cout << format("{:>22} {:>8} {:>10} {:>10} {:>10}", "getter", "keys", "mean ns", "p50 ns", "p99 ns") << endl;
+    auto report = [](const string& case_name, size_t n, const Latency& l) {
+        cout << format("{:>22} {:>8} {:>10.1f} {:>10.1f} {:>10.1f}", case_name, n, l.mean_ns, l.p50_ns, l.p99_ns) << endl;
+        record_latency(case_name, l);
+    };
+    if(!keys.ints.empty()) {
+        report("get_as_int", keys.ints.size(), measure_latency(batches, 16, cycling(keys.ints, [&](const string& key) {
+            return static_cast<int64_t>(cfg.get_as_int(key));
+        })));
+    }
+    if(!keys.doubles.empty()) {
+        report("get_as_double", keys.doubles.size(), measure_latency(batches, 16, cycling(keys.doubles, [&](const string& key) {
+            return static_cast<int64_t>(cfg.get_as_double(key));
+        })));
+    }
+    if(!keys.strs.empty()) {
+        report("get_as_str", keys.strs.size(), measure_latency(batches, 16, cycling(keys.strs, [&](const string& key) {
+            return static_cast<int64_t>(cfg.get_as_str(key).size());
+        })));
+        report("get_as_str_view", keys.strs.size(), measure_latency(batches, 16, cycling(keys.strs, [&](const string& key) {
+            return static_cast<int64_t>(cfg.get_as_str_view(key).size());
+        })));
+    }
+
+    {
+        json doc;
+        stringstream ss(array_sizes);
+        string len;
+        while(getline(ss, len, ',')) {
+            const int n = stoi(len);
+            for(int i = 0; i < n; i++) {
+                doc["ints"][len].push_back(i);
+                doc["doubles"][len].push_back(i / 7.0);
+            }
+        }
+        ofstream(dir / "arrays.json") << doc.dump();
+    }
+    JSONConfig arrays {"bench", "getters"};
+    arrays.load("arrays.json");
+    stringstream ss(array_sizes);
+    string len;
+    while(getline(ss, len, ',')) {
+        const string int_key = "ints/" + len;
+        const string double_key = "doubles/" + len;
+        // keep each sample in the microseconds for the larger arrays
+        const int64_t n_batches = max<int64_t>(batches / max(1, stoi(len) / 16), 100);
+        report("get_as_int_vec/" + len, 1, measure_latency(n_batches, 4, [&] {
+            sink += arrays.get_as_int_vec(int_key).size();
+        }));
+        report("get_as_double_vec/" + len, 1, measure_latency(n_batches, 4, [&] {
+            sink += arrays.get_as_double_vec(double_key).size();
+        }));
+        report("get_as_int_span/" + len, 1, measure_latency(n_batches, 4, [&] {
+            sink += arrays.get_as_int_span(int_key).size();
+        }));
+    }
+    filesystem::remove(dir / "scalars.json");
+    filesystem::remove(dir / "arrays.json");
+    if(sink == 42) {
+        cout << endl;
+    }
+}
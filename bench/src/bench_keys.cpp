@@ -0,0 +1,65 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <string>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// getter latency by how the key is passed: a std::string built at the call
+// site, a long-lived std::string, a string literal (const char*) and a
+// "..."_cfgkey literal hashed at compile time. the keys are literals by
+// nature, so they live in a fixed section added to a generated config.
+
+TANU_BENCH(keys) {
+    const int64_t batches = arg_int(args, "batches", 20000);
+    const auto dir = prepare_conf_dir("bench", "keys");
+
+    GenOptions opts = gen_options(args);
+    opts.target_bytes = static_cast<size_t>(arg_int(args, "size_mb", 4)) << 20;
+    generate_config(dir / "keys.json", opts);
+    json doc = json::parse(ifstream(dir / "keys.json"));
+    doc["service"]["frontend"]["limits"]["max_connections"] = 4096;
+    doc["service"]["frontend"]["limits"]["request_timeout_seconds"] = 2.5;
+    ofstream(dir / "keys.json") << doc.dump();
+    JSONConfig cfg {"bench", "keys"};
+    cfg.load("keys.json");
+
+    cout << format("{:>26} {:>10} {:>10} {:>10}", "key passed as", "mean ns", "p50 ns", "p99 ns") << endl;
+    auto report = [](const string& case_name, const Latency& l) {
+        cout << format("{:>26} {:>10.1f} {:>10.1f} {:>10.1f}", case_name, l.mean_ns, l.p50_ns, l.p99_ns) << endl;
+        record_latency(case_name, l);
+    };
+    volatile double sink = 0;
+    const string int_key {"service/frontend/limits/max_connections"};
+    const string double_key {"service/frontend/limits/request_timeout_seconds"};
+
+    report("int/std::string temporary", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_int(string {"service/frontend/limits/max_connections"});
+    }));
+    report("int/const std::string&", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_int(int_key);
+    }));
+    report("int/const char*", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_int("service/frontend/limits/max_connections");
+    }));
+    report("int/_cfgkey", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_int("service/frontend/limits/max_connections"_cfgkey);
+    }));
+    report("double/std::string temporary", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_double(string {"service/frontend/limits/request_timeout_seconds"});
+    }));
+    report("double/const std::string&", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_double(double_key);
+    }));
+    report("double/const char*", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_double("service/frontend/limits/request_timeout_seconds");
+    }));
+    report("double/_cfgkey", measure_latency(batches, 16, [&] {
+        sink = sink + cfg.get_as_double("service/frontend/limits/request_timeout_seconds"_cfgkey);
+    }));
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <sstream>
+#include <string>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// load time and peak RSS of JSONConfig::load() against the json DOM
+// pipeline it replaced (ifstream -> json::parse -> flatten() -> copy).
+// every run happens in a forked child so each one gets its own peak RSS.
+
+TANU_BENCH(load) {
+    const string sizes = arg_str(args, "sizes", "1,50,500");
+    const auto dir = prepare_conf_dir("bench", "load");
+
+    cout << format("{:>8} {:>10} {:>10} {:>10} {:>14} {:>14}", "size_mb", "loader", "load_s", "MB/s", "peak_rss_mb", "footprint_mb") << endl;
+    stringstream ss(sizes);
+    string size_mb;
+    while(getline(ss, size_mb, ',')) {
+        GenOptions opts = gen_options(args);
+        opts.target_bytes = stoull(size_mb) << 20;
+        const string file_name = format("cfg_{}mb.json", size_mb);
+        const size_t bytes = generate_config(dir / file_name, opts);
+        const double mb = bytes / 1048576.0;
+
+        const ChildRun index = run_in_child([&] {
+            JSONConfig cfg {"bench", "load"};
+            cfg.load(file_name);
+            return static_cast<double>(cfg.memory_usage().total());
+        });
+        const ChildRun dom = run_in_child([&] {
+            ifstream ifs(dir / file_name);
+            json loaded = json::parse(ifs);
+            auto flattened = make_unique<json>(loaded.flatten());
+            auto copy = make_unique<json>(loaded);
+            return 0.0;
+        });
+        cout << format("{:>8.1f} {:>10} {:>10.3f} {:>10.1f} {:>14.1f} {:>14.1f}", mb, "index", index.seconds, mb / index.seconds, index.peak_rss_mb, index.reported / 1048576.0) << endl;
+        cout << format("{:>8.1f} {:>10} {:>10.3f} {:>10.1f} {:>14.1f} {:>14}", mb, "json_dom", dom.seconds, mb / dom.seconds, dom.peak_rss_mb, "-") << endl;
+        for(const auto& [loader, run] : {pair {"index", index}, pair {"json_dom", dom}}) {
+            const string case_name = format("size_mb={}/{}", size_mb, loader);
+            record(case_name, "throughput", mb / run.seconds, "MB/s");
+            record(case_name, "peak_rss", run.peak_rss_mb, "MB");
+        }
+        record(format("size_mb={}/index", size_mb), "footprint", index.reported / 1048576.0, "MB");
+        filesystem::remove(dir / file_name);
+    }
+}
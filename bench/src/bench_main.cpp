@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "nlohmann/json/json.hpp"
+#include "bench.h"
+
+using namespace std;
+using namespace tanu::cfg::bench;
+
+namespace tanu::cfg::bench {
+
+    map<string, BenchFn>& registry() {
+        static map<string, BenchFn> benches;
+        return benches;
+    }
+
+    int64_t arg_int(const BenchArgs& args, const string& name, int64_t default_value) {
+        auto it = args.find(name);
+        return it == args.end() ? default_value : stoll(it->second);
+    }
+
+    string arg_str(const BenchArgs& args, const string& name, const string& default_value) {
+        auto it = args.find(name);
+        return it == args.end() ? default_value : it->second;
+    }
+
+    namespace {
+        string running_bench;
+        vector<nlohmann::json> records;
+    }
+
+    void record(const string& case_name, const string& metric, double value, const string& unit) {
+        records.push_back({
+            {"bench", running_bench},
+            {"case", case_name},
+            {"metric", metric},
+            {"value", value},
+            {"unit", unit}});
+    }
+
+    void record_latency(const string& case_name, const Latency& l) {
+        record(case_name, "mean", l.mean_ns, "ns");
+        record(case_name, "p50", l.p50_ns, "ns");
+        record(case_name, "p99", l.p99_ns, "ns");
+    }
+
+    filesystem::path prepare_conf_dir(const string& group, const string& app) {
+        const auto base = filesystem::temp_directory_path() / "cpptanu_cfg_bench";
+        filesystem::create_directories(base / group / app);
+        setenv("NEKOKAN_CONF_DIR", base.c_str(), 1);
+        return base / group / app;
+    }
+
+    namespace {
+        long rss_kb() {
+            ifstream statm("/proc/self/statm");
+            long size = 0, resident = 0;
+            statm >> size >> resident;
+            return resident * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    }
+
+    ChildRun run_in_child(const function<double()>& fn) {
+        int fds[2];
+        if(pipe(fds) != 0) {
+            throw runtime_error("pipe failed");
+        }
+        const pid_t pid = fork();
+        if(pid == 0) {
+            close(fds[0]);
+            const long before_kb = rss_kb();
+            const auto t0 = chrono::steady_clock::now();
+            const double reported = fn();
+            const double sample[3] = {seconds_since(t0), static_cast<double>(before_kb), reported};
+            [[maybe_unused]] const ssize_t n = write(fds[1], sample, sizeof(sample));
+            _exit(0);
+        }
+        close(fds[1]);
+        double sample[3] = {0, 0, 0};
+        [[maybe_unused]] const ssize_t n = read(fds[0], sample, sizeof(sample));
+        close(fds[0]);
+        int status = 0;
+        struct rusage usage {};
+        wait4(pid, &status, 0, &usage);
+        // ru_maxrss is in KB on linux
+        return ChildRun {sample[0], (usage.ru_maxrss - sample[1]) / 1024.0, sample[2]};
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const string name = argc > 1 ? argv[1] : "all";
+    BenchArgs args;
+    for(int i = 2; i < argc; i++) {
+        const string opt {argv[i]};
+        const auto eq = opt.find('=');
+        if(opt.rfind("--", 0) != 0 || eq == string::npos) {
+            cerr << "options are --name=value, got " << opt << endl;
+            return 1;
+        }
+        args[opt.substr(2, eq - 2)] = opt.substr(eq + 1);
+    }
+
+    if(name != "all" && registry().count(name) == 0) {
+        cerr << "unknown benchmark " << name << "; available:" << endl;
+        for(const auto& [bench_name, fn] : registry()) {
+            cerr << "  " << bench_name << endl;
+        }
+        return 1;
+    }
+    for(const auto& [bench_name, fn] : registry()) {
+        if(name == "all" || name == bench_name) {
+            cout << "== " << bench_name << endl;
+            running_bench = bench_name;
+            fn(args);
+        }
+    }
+
+    // one json object per line: bench, case, metric, value, unit
+    const string out = arg_str(args, "out", "");
+    if(!out.empty()) {
+        ofstream ofs(out);
+        for(const auto& r : records) {
+            ofs << r.dump() << '\n';
+        }
+        if(!ofs) {
+            cerr << "failed to write " << out << endl;
+            return 1;
+        }
+        cout << records.size() << " results written to " << out << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "bench.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// getter throughput from 1 to --threads readers. besides JSONConfig's own
+// getters it runs the two read paths a shared config usually ends up with:
+// taking a shared_ptr reference per read, and a mutex around the lookup.
+
+namespace {
+
+    struct alignas(64) ThreadResult {
+        uint64_t ops = 0;
+    };
+
+    template<typename ReadFn>
+    double run_readers(int threads, double seconds, const vector<string>& keys, ReadFn read) {
+        atomic<bool> start {false};
+        atomic<bool> stop {false};
+        vector<ThreadResult> results(threads);
+        vector<thread> workers;
+        for(int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                while(!start.load(memory_order_acquire)) {
+                    this_thread::yield();
+                }
+                uint64_t ops = 0;
+                int64_t sink = 0;
+                size_t k = t;
+                while(!stop.load(memory_order_relaxed)) {
+                    for(int i = 0; i < 64; i++) {
+                        sink += read(keys[k]);
+                        k = (k + 1) % keys.size();
+                    }
+                    ops += 64;
+                }
+                results[t].ops = ops + (sink == 42 ? 1 : 0);
+            });
+        }
+        const auto t0 = chrono::steady_clock::now();
+        start.store(true, memory_order_release);
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+        stop.store(true);
+        for(auto& w : workers) {
+            w.join();
+        }
+        const double elapsed = seconds_since(t0);
+        uint64_t total = 0;
+        for(const auto& r : results) {
+            total += r.ops;
+        }
+        return total / elapsed;
+    }
+
+}
+
+TANU_BENCH(mt_read) {
+    const int max_threads = static_cast<int>(arg_int(args, "threads", max(1u, thread::hardware_concurrency())));
+    const double seconds = arg_int(args, "millis", 500) / 1000.0;
+    const int n_keys = static_cast<int>(arg_int(args, "keys", 1024));
+
+    const auto dir = prepare_conf_dir("bench", "mt_read");
+    vector<string> keys;
+    {
+        json doc;
+        for(int i = 0; i < n_keys; i++) {
+            const string section = format("section_{}", i % 32);
+            const string name = format("key_{}", i);
+            doc[section][name] = i;
+            keys.push_back(section + "/" + name);
+        }
+        ofstream(dir / "cfg.json") << doc.dump();
+    }
+    JSONConfig cfg {"bench", "mt_read"};
+    cfg.load("cfg.json");
+    mutex mtx;
+
+    cout << format("{:>8} {:>16} {:>16} {:>16}", "threads", "getter Mops/s", "refcount Mops/s", "mutex Mops/s") << endl;
+    // 1, 2, 4, ... below max_threads, then max_threads itself once
+    for(int threads = 1; ; threads = min(threads * 2, max_threads)) {
+        const double getter = run_readers(threads, seconds, keys, [&](const string& key) {
+            return static_cast<int64_t>(cfg.get_as_int(key));
+        });
+        const double refcount = run_readers(threads, seconds, keys, [&](const string& key) {
+            const shared_ptr<const CfgSnapshot> snapshot = cfg.snapshot();
+            return snapshot->index.find(key)->i;
+        });
+        const double locked = run_readers(threads, seconds, keys, [&](const string& key) {
+            lock_guard<mutex> lock(mtx);
+            return static_cast<int64_t>(cfg.get_as_int(key));
+        });
+        cout << format("{:>8} {:>16.2f} {:>16.2f} {:>16.2f}", threads, getter / 1e6, refcount / 1e6, locked / 1e6) << endl;
+        record(format("threads={}/getter", threads), "throughput", getter / 1e6, "Mops/s");
+        record(format("threads={}/refcount", threads), "throughput", refcount / 1e6, "Mops/s");
+        record(format("threads={}/mutex", threads), "throughput", locked / 1e6, "Mops/s");
+        if(threads == max_threads) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_read.h"
+#include "cpptanu_cfg/cfg_schema.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// what validating a generated config against a schema that covers every key
+// of it costs, next to the load itself. the schema is derived from the
+// document: every member required and typed, numbers bounded, arrays with
+// an element type. then the per-get cost of a checked getter against
+// get_unchecked() on a key the schema guarantees.
+
+namespace {
+    json derive_schema(const json& v) {
+        json s = json::object();
+        switch(v.type()) {
+            case json::value_t::object: {
+                s["type"] = "object";
+                s["properties"] = json::object();
+                s["required"] = json::array();
+                for(const auto& [name, member] : v.items()) {
+                    s["properties"][name] = derive_schema(member);
+                    s["required"].push_back(name);
+                }
+                break;
+            }
+            case json::value_t::array:
+                s["type"] = "array";
+                s["maxItems"] = v.size();
+                if(!v.empty()) {
+                    s["items"] = derive_schema(v.front());
+                    s["items"].erase("required");
+                    // mixed numeric arrays
+                    if(s["items"]["type"] == "integer" && std::ranges::any_of(v, [](const json& e) { return e.is_number_float(); })) {
+                        s["items"]["type"] = "number";
+                    }
+                }
+                break;
+            case json::value_t::string:
+                s["type"] = "string";
+                break;
+            case json::value_t::boolean:
+                s["type"] = "boolean";
+                break;
+            case json::value_t::number_float:
+                s["type"] = "number";
+                s["minimum"] = -1e300;
+                s["maximum"] = 1e300;
+                break;
+            case json::value_t::number_integer:
+            case json::value_t::number_unsigned:
+                s["type"] = "integer";
+                s["minimum"] = -1e18;
+                s["maximum"] = 1e19;
+                break;
+            default:
+                s["type"] = "null";
+                break;
+        }
+        return s;
+    }
+
+    // the first integer leaf reachable through objects alone
+    string first_int_key(const json& v, const string& path) {
+        for(const auto& [name, member] : v.items()) {
+            if(member.is_number_integer()) {
+                return path + "/" + name;
+            }
+            if(member.is_object()) {
+                const string key = first_int_key(member, path + "/" + name);
+                if(!key.empty()) {
+                    return key;
+                }
+            }
+        }
+        return "";
+    }
+}
+
+TANU_BENCH(schema) {
+    const string sizes = arg_str(args, "sizes", "1,20");
+    const int runs = static_cast<int>(arg_int(args, "runs", 3));
+    const auto dir = prepare_conf_dir("bench", "schema");
+
+    cout << format("{:>8} {:>8} {:>10} {:>12} {:>12} {:>10}", "size_mb", "rules", "load_ms", "validate_ms", "checked_ms", "overhead") << endl;
+    stringstream ss(sizes);
+    string size_mb;
+    while(getline(ss, size_mb, ',')) {
+        GenOptions opts = gen_options(args);
+        opts.target_bytes = stoull(size_mb) << 20;
+        const string file_name = format("cfg_{}mb.json", size_mb);
+        generate_config(dir / file_name, opts);
+        const json doc = json::parse(ifstream(dir / file_name));
+        const auto schema = make_shared<const CfgSchema>(CfgSchema::compile(derive_schema(doc)));
+
+        double load_s = 0;
+        double checked_s = 0;
+        double validate_s = 0;
+        for(int r = 0; r < runs; r++) {
+            JSONConfig plain {"bench", "schema"};
+            auto t0 = chrono::steady_clock::now();
+            plain.load(file_name);
+            load_s += seconds_since(t0);
+
+            JSONConfig checked {"bench", "schema"};
+            checked.set_schema(schema);
+            t0 = chrono::steady_clock::now();
+            checked.load(file_name);
+            checked_s += seconds_since(t0);
+
+            const shared_ptr<const CfgSnapshot> snapshot = plain.snapshot();
+            t0 = chrono::steady_clock::now();
+            if(!schema->validate(snapshot->index).empty()) {
+                throw runtime_error("generated config does not match its own schema");
+            }
+            validate_s += seconds_since(t0);
+        }
+        const double load_ms = load_s / runs * 1000;
+        const double validate_ms = validate_s / runs * 1000;
+        const double checked_ms = checked_s / runs * 1000;
+        cout << format("{:>8} {:>8} {:>10.2f} {:>12.2f} {:>12.2f} {:>9.1f}%", size_mb, schema->rule_count(), load_ms, validate_ms, checked_ms,
+            validate_ms / load_ms * 100) << endl;
+        const string case_name = format("size_mb={}", size_mb);
+        record(case_name, "load", load_ms, "ms");
+        record(case_name, "validate", validate_ms, "ms");
+        record(case_name, "load_validated", checked_ms, "ms");
+        record(case_name, "rules", static_cast<double>(schema->rule_count()), "count");
+
+        const string key = first_int_key(doc, "");
+        if(!key.empty()) {
+            JSONConfig cfg {"bench", "schema"};
+            cfg.set_schema(schema);
+            cfg.load(file_name);
+            volatile int64_t sink = 0;
+            const Latency getter = measure_latency(200, 1000, [&] { sink = sink + cfg.get_as_int64(key); });
+            const Latency unchecked = measure_latency(200, 1000, [&] { sink = sink + cfg.get_unchecked<int64_t>(key); });
+            cout << format("  {}: get_as_int64 {:.1f} ns, get_unchecked {:.1f} ns", key, getter.mean_ns, unchecked.mean_ns) << endl;
+            record_latency(case_name + "/get_as_int64", getter);
+            record_latency(case_name + "/get_unchecked", unchecked);
+        }
+        filesystem::remove(dir / file_name);
+    }
+}
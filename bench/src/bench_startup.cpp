@@ -0,0 +1,93 @@
+#include <iostream>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "bench.h"
+#include "cfg_gen.h"
+#include "cpptanu_cfg/cfg_lazy.h"
+#include "cpptanu_cfg/cfg_read.h"
+#include "cpptanu_cfg/cfg_shm.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// process startup cost of JSONConfig::load(): parsing every time, the
+// first load with the compiled cache (parse + write image) and every later
+// one (map the image), the same two for the shared memory segment, and a
+// lazy load followed by one get, which parses a single section.
+// each run is a fresh forked process.
+
+TANU_BENCH(startup) {
+    const string sizes = arg_str(args, "sizes", "1,50");
+    const int runs = static_cast<int>(arg_int(args, "runs", 5));
+    const auto dir = prepare_conf_dir("bench", "startup");
+
+    cout << format("{:>8} {:>8} {:>12} {:>14}", "size_mb", "mode", "load_ms", "peak_rss_mb") << endl;
+    stringstream ss(sizes);
+    string size_mb;
+    while(getline(ss, size_mb, ',')) {
+        GenOptions opts = gen_options(args);
+        opts.target_bytes = stoull(size_mb) << 20;
+        const string file_name = format("cfg_{}mb.json", size_mb);
+        const double mb = generate_config(dir / file_name, opts) / 1048576.0;
+        const auto image_path = cfg_image_path(dir / file_name);
+
+        // the key the lazy run reads: the first member of the first section
+        string first_key;
+        {
+            ifstream in(dir / file_name, ios::binary);
+            const string text {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+            vector<CfgSectionSpan> spans;
+            cfg_scan_sections(text, spans);
+            for(const CfgSectionSpan& span : spans) {
+                if(span.parent >= 0) {
+                    first_key = format("/{}/{}", spans[span.parent].name, span.name);
+                    break;
+                }
+            }
+        }
+
+        auto load = [&](bool use_image, bool use_shared = false, bool lazy = false) {
+            return run_in_child([&] {
+                JSONConfig cfg {"bench", "startup"};
+                cfg.set_compiled_cache(use_image);
+                cfg.set_shared_memory(use_shared);
+                cfg.set_lazy_sections(lazy);
+                cfg.load(file_name);
+                if(lazy) {
+                    cfg.try_get_as_int(first_key);
+                }
+                return 0.0;
+            });
+        };
+        auto report = [&](const char* mode, auto&& one_run) {
+            double total_s = 0, peak_mb = 0;
+            for(int i = 0; i < runs; i++) {
+                const ChildRun r = one_run();
+                total_s += r.seconds;
+                peak_mb = max(peak_mb, r.peak_rss_mb);
+            }
+            cout << format("{:>8.1f} {:>8} {:>12.2f} {:>14.1f}", mb, mode, total_s / runs * 1000, peak_mb) << endl;
+            record(format("size_mb={}/{}", size_mb, mode), "load", total_s / runs * 1000, "ms");
+            record(format("size_mb={}/{}", size_mb, mode), "peak_rss", peak_mb, "MB");
+        };
+
+        report("parse", [&] { return load(false); });
+        report("cold", [&] {
+            filesystem::remove(image_path);
+            return load(true);
+        });
+        report("warm", [&] { return load(true); });
+        report("shm_cold", [&] {
+            CfgSharedSegments::unlink(dir / file_name);
+            return load(false, true);
+        });
+        report("shm_warm", [&] { return load(false, true); });
+        report("lazy", [&] { return load(false, false, true); });
+        CfgSharedSegments::unlink(dir / file_name);
+        filesystem::remove(image_path);
+        filesystem::remove(dir / file_name);
+    }
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <string>
+#include <string_view>
+#include "bench.h"
+#include "cpptanu_cfg/cfg_read.h"
+
+using namespace std;
+using namespace tanu::cfg;
+using namespace tanu::cfg::bench;
+
+// hit and miss latency of an optional int key through the throwing getter
+// (miss caught by the caller), try_get_as_int() and get_or()
+
+namespace {
+
+    constexpr int BATCH = 64;
+
+}
+
+TANU_BENCH(try_get) {
+    const int64_t batches = arg_int(args, "batches", 20000);
+    const auto dir = prepare_conf_dir("bench", "try_get");
+    ofstream(dir / "cfg.json") << R"({
+        "server": {"port": 8080, "workers": 16, "host": "0.0.0.0"},
+        "limits": {"max_conn": 1024}
+    })";
+    JSONConfig cfg {"bench", "try_get"};
+    cfg.load("cfg.json");
+
+    int64_t sink = 0;
+    auto throwing = [&](string_view key) {
+        return [&, key] {
+            try {
+                sink += cfg.get_as_int(key);
+            } catch(const TanuCfgException&) {
+                sink += 1;
+            }
+        };
+    };
+    auto expected = [&](string_view key) {
+        return [&, key] {
+            sink += cfg.try_get_as_int(key).value_or(1);
+        };
+    };
+    auto defaulted = [&](string_view key) {
+        return [&, key] {
+            sink += cfg.get_or(key, 1);
+        };
+    };
+
+    constexpr string_view hit {"limits/max_conn"};
+    constexpr string_view miss {"limits/max_streams"};
+    cout << format("{:>14} {:>6} {:>10} {:>10}", "api", "case", "mean ns", "p99 ns") << endl;
+    auto report = [](string_view api, string_view which, Latency l) {
+        cout << format("{:>14} {:>6} {:>10.1f} {:>10.1f}", api, which, l.mean_ns, l.p99_ns) << endl;
+        record_latency(format("{}/{}", api, which), l);
+    };
+    report("get_as_int", "hit", measure_latency(batches, BATCH, throwing(hit)));
+    report("get_as_int", "miss", measure_latency(batches / 16, BATCH, throwing(miss)));
+    report("try_get_as_int", "hit", measure_latency(batches, BATCH, expected(hit)));
+    report("try_get_as_int", "miss", measure_latency(batches, BATCH, expected(miss)));
+    report("get_or", "hit", measure_latency(batches, BATCH, defaulted(hit)));
+    report("get_or", "miss", measure_latency(batches, BATCH, defaulted(miss)));
+    if(sink == 42) {
+        cout << endl;
+    }
+}
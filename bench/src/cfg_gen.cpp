@@ -0,0 +1,114 @@
+#include <fstream>
+#include <format>
+#include <random>
+#include <string>
+#include "cfg_gen.h"
+
+using namespace std;
+
+namespace tanu::cfg::bench {
+
+    namespace {
+
+        class Generator {
+        private:
+            const GenOptions& m_opts;
+            mt19937_64 m_rng;
+            string m_buf;
+            ofstream m_out;
+            size_t m_written;
+
+            string key(const char* prefix, size_t n) {
+                string k = format("{}{}_", prefix, n);
+                while(k.size() < static_cast<size_t>(m_opts.key_len)) {
+                    k.push_back(static_cast<char>('a' + m_rng() % 26));
+                }
+                return k;
+            }
+
+            void flush_if_full() {
+                if(m_buf.size() >= (1 << 20)) {
+                    m_out.write(m_buf.data(), m_buf.size());
+                    m_written += m_buf.size();
+                    m_buf.clear();
+                }
+            }
+
+            void leaf(size_t n) {
+                switch(m_rng() % 6) {
+                    case 0:
+                        m_buf += to_string(static_cast<int64_t>(m_rng() % 2000000) - 1000000);
+                        break;
+                    case 1:
+                        m_buf += format("{}", static_cast<double>(m_rng() % 10000000) / 997.0);
+                        break;
+                    case 2:
+                        m_buf += format("\"{}\"", key("val", n));
+                        break;
+                    case 3:
+                        m_buf += (m_rng() % 2) ? "true" : "false";
+                        break;
+                    case 4:
+                        m_buf.push_back('[');
+                        for(int i = 0; i < m_opts.array_len; i++) {
+                            m_buf += format("{}{}", i ? "," : "", static_cast<double>(m_rng() % 1000000) / 113.0);
+                        }
+                        m_buf.push_back(']');
+                        break;
+                    default:
+                        m_buf.push_back('[');
+                        for(int i = 0; i < m_opts.array_len; i++) {
+                            m_buf += format("{}{}", i ? "," : "", static_cast<int64_t>(m_rng() % 100000));
+                        }
+                        m_buf.push_back(']');
+                        break;
+                }
+            }
+
+            void object(int depth) {
+                m_buf.push_back('{');
+                for(int i = 0; i < m_opts.fanout; i++) {
+                    m_buf += format("{}\"{}\":", i ? "," : "", key("k", i));
+                    if(depth > 0 && i % 2 == 0) {
+                        object(depth - 1);
+                    } else {
+                        leaf(i);
+                    }
+                    flush_if_full();
+                }
+                m_buf.push_back('}');
+            }
+
+        public:
+            Generator(const filesystem::path& out, const GenOptions& opts): m_opts(opts), m_rng(opts.seed), m_out(out, ios::binary), m_written(0) {}
+
+            size_t run() {
+                m_buf.push_back('{');
+                for(size_t section = 0; section == 0 || m_written + m_buf.size() < m_opts.target_bytes; section++) {
+                    m_buf += format("{}\"{}\":", section ? "," : "", key("section", section));
+                    object(m_opts.depth);
+                    flush_if_full();
+                }
+                m_buf.push_back('}');
+                m_out.write(m_buf.data(), m_buf.size());
+                return m_written + m_buf.size();
+            }
+        };
+
+    }
+
+    size_t generate_config(const filesystem::path& out, const GenOptions& opts) {
+        return Generator(out, opts).run();
+    }
+
+    GenOptions gen_options(const BenchArgs& args) {
+        GenOptions opts;
+        opts.depth = static_cast<int>(arg_int(args, "depth", opts.depth));
+        opts.fanout = static_cast<int>(arg_int(args, "fanout", opts.fanout));
+        opts.array_len = static_cast<int>(arg_int(args, "array_len", opts.array_len));
+        opts.key_len = static_cast<int>(arg_int(args, "key_len", opts.key_len));
+        opts.seed = static_cast<uint64_t>(arg_int(args, "seed", static_cast<int64_t>(opts.seed)));
+        return opts;
+    }
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef __CFG_BATCH_H__
+#define __CFG_BATCH_H__
+
+#include "cpptanu_cfg/cfg_read.h"
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tanu::cfg {
+
+    // one config to bring up at startup: JSONConfig{group, app}.load(file)
+    struct CfgLoadRequest {
+        std::string group;
+        std::string app;
+        std::string file;
+    };
+
+    // outcome of one request. config is set whenever it could be
+    // constructed, loaded or not; error holds the reason a load failed.
+    struct CfgLoadResult {
+        std::unique_ptr<JSONConfig> config;
+        std::optional<std::string> error;
+
+        bool ok() const noexcept {
+            return !error.has_value();
+        }
+    };
+
+    // constructs and loads every request concurrently on at most
+    // max_threads threads (0: one per hardware thread), so boot costs about
+    // the slowest parse rather than the sum of them. results come back in
+    // request order; a failed file is reported in its own result and does
+    // not affect the others.
+    std::vector<CfgLoadResult> cfg_load_all(std::span<const CfgLoadRequest> requests, size_t max_threads = 0);
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef __CFG_BIND_H__
+#define __CFG_BIND_H__
+
+#include "cpptanu_cfg/cfg_index.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace tanu::cfg {
+
+    // member types JSONConfig::bind() can fill, on their own or wrapped in
+    // std::optional (absent or null keys then leave it empty)
+    template<typename T>
+    inline constexpr bool cfg_bindable_value =
+        std::is_same_v<T, int> || std::is_same_v<T, int64_t> || std::is_same_v<T, double>
+        || std::is_same_v<T, bool> || std::is_same_v<T, std::string>
+        || std::is_same_v<T, std::vector<int>> || std::is_same_v<T, std::vector<int64_t>>
+        || std::is_same_v<T, std::vector<double>> || std::is_same_v<T, std::vector<std::string>>;
+
+    template<typename T>
+    inline constexpr bool cfg_bindable_member = cfg_bindable_value<T>;
+
+    template<typename T>
+    inline constexpr bool cfg_bindable_member<std::optional<T>> = cfg_bindable_value<T>;
+
+    // one member of S and the json pointer path it is read from. the path is
+    // hashed at compile time, so binding never hashes or formats a key.
+    template<typename S, typename T>
+    struct CfgField {
+        std::string_view path;
+        uint64_t hash;
+        T S::* member;
+    };
+
+    template<typename S, typename T>
+    consteval CfgField<S, T> cfg_field(std::string_view path, T S::* member) {
+        static_assert(cfg_bindable_member<T>, "cfg_field: unsupported member type");
+        return CfgField<S, T> {path, cfg_key_hash(path), member};
+    }
+
+    // specialize for every struct JSONConfig::bind() should fill:
+    //
+    //   template<> struct tanu::cfg::CfgBinding<ServerSettings> {
+    //       static constexpr auto fields = std::make_tuple(
+    //           cfg_field("server/port", &ServerSettings::port),
+    //           cfg_field("server/hosts", &ServerSettings::hosts));
+    //   };
+    template<typename S>
+    struct CfgBinding;
+
+    template<typename S>
+    concept CfgBindable = requires { CfgBinding<S>::fields; };
+
+    // false if two fields of a binding read the same path
+    template<typename Fields>
+    consteval bool cfg_paths_unique(const Fields& fields) {
+        return std::apply([](const auto&... field) {
+            constexpr size_t count = sizeof...(field);
+            if constexpr (count < 2) {
+                return true;
+            } else {
+                const std::string_view paths[count] = {field.path...};
+                for(size_t i = 0; i < count; i++) {
+                    for(size_t j = i + 1; j < count; j++) {
+                        std::string_view a = paths[i];
+                        std::string_view b = paths[j];
+                        if(a.starts_with('/')) a.remove_prefix(1);
+                        if(b.starts_with('/')) b.remove_prefix(1);
+                        if(a == b) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+        }, fields);
+    }
+
+}
+
+#endif
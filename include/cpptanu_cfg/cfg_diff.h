@@ -0,0 +1,38 @@
+#pragma once
+#ifndef __CFG_DIFF_H__
+#define __CFG_DIFF_H__
+
+#include "cpptanu_cfg/cfg_index.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tanu::cfg {
+
+    // leaf-level changes between two versions of a config, keyed like the
+    // flattened view ("/detail/lang"; empty arrays and objects are leaves).
+    // a leaf that turned into a container, or back, is removed under its
+    // old keys and added under its new ones.
+    struct CfgDiff {
+        uint64_t from_version = 0;
+        uint64_t to_version = 0;
+        // in document order of the version that has them
+        std::vector<std::string> added;
+        std::vector<std::string> removed;
+        std::vector<std::string> changed;
+
+        bool empty() const noexcept {
+            return added.empty() && removed.empty() && changed.empty();
+        }
+        // the changes under prefix, matched by whole segments: "detail"
+        // covers /detail and /detail/lang but not /details. "" covers all.
+        CfgDiff under(std::string_view prefix) const;
+    };
+
+    // one lookup in after per leaf of before and the other way round
+    CfgDiff cfg_diff(const CfgIndex& before, const CfgIndex& after);
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef __CFG_DUMP_H__
+#define __CFG_DUMP_H__
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace tanu::cfg {
+
+    // receives a streamed dump one chunk at a time. a chunk is only valid
+    // during the call.
+    using CfgSink = std::function<void(std::string_view chunk)>;
+
+    struct CfgDumpOptions {
+        // key of the value to dump, "" for the whole document. matched by
+        // whole segments like any other key: "detail" dumps /detail, not
+        // /details.
+        std::string prefix {};
+        // container levels written below the dumped value; deeper non-empty
+        // containers come out as {} or [] (and are left out of a flattened
+        // dump). negative for no limit.
+        int max_depth = -1;
+        // spaces per level, or negative for compact output, as json::dump()
+        int indent = -1;
+        // every leaf by its json pointer key, the shape of
+        // dump_flattened_view(), instead of the nested document
+        bool flattened = false;
+        // bytes buffered between sink calls; a string value longer than that
+        // is passed on in one chunk
+        size_t chunk_size = 64 << 10;
+    };
+
+    // sinks for the usual destinations. the fd one retries short writes and
+    // throws std::system_error when write() fails; the ostream one leaves
+    // errors in the stream state.
+    CfgSink cfg_ostream_sink(std::ostream& out);
+    CfgSink cfg_fd_sink(int fd);
+
+}
+
+#endif
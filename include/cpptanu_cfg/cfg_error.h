@@ -0,0 +1,34 @@
+#pragma once
+#ifndef __CFG_ERROR_H__
+#define __CFG_ERROR_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tanu::cfg {
+
+    enum class CfgErrc : uint8_t {
+        NotLoaded,
+        NotFound,
+        TypeMismatch,
+        // the key's section failed to parse, with lazy sections enabled
+        Malformed,
+        // an integer that doesn't fit the type asked for
+        OutOfRange
+    };
+
+    // why a try_get_as_* call came back empty. it only refers to the
+    // caller's key and a static type name, so reporting a miss never
+    // allocates; message() formats it the way the throwing getters would.
+    struct CfgError {
+        CfgErrc code;
+        std::string_view key;
+        const char* expected;
+
+        std::string message() const;
+    };
+
+}
+
+#endif
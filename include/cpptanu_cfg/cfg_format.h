@@ -0,0 +1,37 @@
+#pragma once
+#ifndef __CFG_FORMAT_H__
+#define __CFG_FORMAT_H__
+
+#include "nlohmann/json/json.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace tanu::cfg {
+
+    // encodings a config file can come in. the binary ones are indexed
+    // straight from their bytes, like text json, without building a json
+    // document first.
+    enum class CfgFormat : uint8_t {
+        Json,
+        Cbor,
+        MsgPack,
+        Bson
+    };
+
+    const char* cfg_format_name(CfgFormat format) noexcept;
+    // "json", "cbor", "msgpack" or "bson"
+    std::optional<CfgFormat> cfg_format_from_name(std::string_view name) noexcept;
+    // by extension (.json, .cbor, .msgpack or .mpk, .bson), failing that by
+    // the leading bytes of an object in each encoding; text json otherwise
+    CfgFormat cfg_detect_format(const std::filesystem::path& fpath, std::string_view bytes) noexcept;
+    // doc in the given binary encoding, e.g. to convert a json config
+    std::vector<uint8_t> cfg_encode(const json& doc, CfgFormat format);
+
+}
+
+#endif
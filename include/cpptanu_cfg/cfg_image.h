@@ -0,0 +1,30 @@
+#pragma once
+#ifndef __CFG_IMAGE_H__
+#define __CFG_IMAGE_H__
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace tanu::cfg {
+
+    // what a compiled image was built from. an image is only used while its
+    // source still has the same path, size and mtime, or failing the mtime,
+    // the same content hash.
+    struct CfgImageKey {
+        std::string source;
+        uint64_t size;
+        int64_t mtime;
+        uint64_t hash;
+    };
+
+    // the compiled image sits next to its source: utest.json -> utest.json.tcfg
+    std::filesystem::path cfg_image_path(const std::filesystem::path& source);
+
+    // cheap 64-bit hash of a whole file, only used to spot changed content
+    uint64_t cfg_content_hash(std::string_view bytes) noexcept;
+
+}
+
+#endif
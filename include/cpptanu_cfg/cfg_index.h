@@ -0,0 +1,436 @@
+#pragma once
+#ifndef __CFG_INDEX_H__
+#define __CFG_INDEX_H__
+
+#include "nlohmann/json/json.hpp"
+#include "cpptanu_cfg/cfg_dump.h"
+#include "cpptanu_cfg/cfg_format.h"
+#include "cpptanu_cfg/cfg_image.h"
+#include "cpptanu_cfg/cfg_mmap.h"
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace tanu::cfg {
+
+    enum class CfgType : uint8_t {
+        Null,
+        Bool,
+        Int,
+        UInt,
+        Double,
+        String,
+        Array,
+        Object
+    };
+
+    // one node of the loaded document. containers refer to their children
+    // by a [begin, begin + count) range in the same value table. homogeneous
+    // int/double/string arrays are also copied into a typed pool, and pool is
+    // the offset of their first element there (npos otherwise).
+    struct CfgValue {
+        CfgType type;
+        uint32_t pool;
+        union {
+            bool b;
+            int64_t i;
+            uint64_t u;
+            double d;
+            struct { uint32_t off; uint32_t len; } str;
+            struct { uint32_t begin; uint32_t count; } range;
+        };
+    };
+
+    // keeps large numeric arrays on their own cache lines
+    template<typename T, size_t Align = 64>
+    struct AlignedAllocator {
+        using value_type = T;
+        AlignedAllocator() = default;
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+        template<typename U>
+        struct rebind { using other = AlignedAllocator<U, Align>; };
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t {Align}));
+        }
+        void deallocate(T* p, size_t) noexcept {
+            ::operator delete(p, std::align_val_t {Align});
+        }
+        bool operator==(const AlignedAllocator&) const noexcept { return true; }
+    };
+
+    constexpr uint64_t CFG_KEY_HASH_BASIS = 14695981039346656037ull;
+
+    constexpr uint64_t cfg_key_hash_step(uint64_t h, char c) noexcept {
+        return (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+
+    // FNV-1a over the json pointer form of key; a missing leading '/' is
+    // hashed as if it were there so callers never have to build the path.
+    constexpr uint64_t cfg_key_hash(std::string_view key) noexcept {
+        uint64_t h = CFG_KEY_HASH_BASIS;
+        if(key.empty() || key.front() != '/') {
+            h = cfg_key_hash_step(h, '/');
+        }
+        for(const char c : key) {
+            h = cfg_key_hash_step(h, c);
+        }
+        return h;
+    }
+
+    // name escaped as a json pointer segment ("a/b" -> "a~1b"), the way
+    // keys spell it
+    std::string cfg_pointer_segment(std::string_view name);
+
+    // footprint of one loaded config, in bytes
+    struct CfgMemoryUsage {
+        // value table and the tree links between values
+        size_t values;
+        // interned key segments
+        size_t keys;
+        // interned string leaves and views of them
+        size_t strings;
+        // hash slots
+        size_t table;
+        // typed array pools
+        size_t arrays;
+
+        size_t total() const noexcept {
+            return values + keys + strings + table + arrays;
+        }
+    };
+
+    class CfgIndex;
+
+    // one leaf of a path range. key is its json pointer path and stays
+    // valid until the iterator moves on.
+    struct CfgEntry {
+        std::string_view key;
+        const CfgValue& value;
+    };
+
+    // lazy, document-ordered walk over the leaves (and empty containers)
+    // below a node of a CfgIndex, keyed like to_flattened_json(). nothing
+    // is collected up front: the iterator keeps a stack of pending
+    // siblings and the path it is at.
+    class CfgPathRange : public std::ranges::view_interface<CfgPathRange> {
+    public:
+        class iterator {
+        public:
+            using value_type = CfgEntry;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            CfgEntry operator*() const noexcept;
+            iterator& operator++();
+            void operator++(int) {
+                ++*this;
+            }
+            bool operator==(std::default_sentinel_t) const noexcept {
+                return m_current == UINT32_MAX;
+            }
+
+        private:
+            struct Pending {
+                uint32_t idx;
+                // length of the parent's path
+                uint32_t path_len;
+            };
+
+            const CfgIndex* m_index = nullptr;
+            std::vector<Pending> m_stack;
+            std::string m_path;
+            uint32_t m_current = UINT32_MAX;
+
+            friend class CfgPathRange;
+        };
+
+        CfgPathRange() = default;
+        iterator begin() const;
+        std::default_sentinel_t end() const noexcept {
+            return {};
+        }
+
+    private:
+        const CfgIndex* m_index = nullptr;
+        // the node to walk, and whether to start at the node itself or at
+        // its children whose segment begins with m_partial
+        uint32_t m_node = UINT32_MAX;
+        bool m_self = false;
+        std::string m_base;
+        std::string m_partial;
+
+        CfgPathRange(const CfgIndex* index, uint32_t node, bool self, std::string_view base, std::string_view partial):
+            m_index(index), m_node(node), m_self(self), m_base(base), m_partial(partial) {}
+        friend class CfgIndex;
+    };
+
+    // yields just the keys of a CfgPathRange
+    struct CfgEntryKey {
+        std::string_view operator()(const CfgEntry& e) const noexcept {
+            return e.key;
+        }
+    };
+    using CfgKeyRange = std::ranges::transform_view<CfgPathRange, CfgEntryKey>;
+
+    // flat, read-only index of a parsed document keyed by json pointer path
+    // (the same keys json::flatten() produces). lookups are a single probe of
+    // an open-addressing table and never allocate.
+    //
+    // everything lives in one arena. paths are not stored whole: each value
+    // links to its parent and names its own segment, and equal member names
+    // and equal string leaves are stored once.
+    class CfgIndex {
+    public:
+        class Builder;
+        static constexpr uint32_t npos = UINT32_MAX;
+
+        // indexes an already parsed document
+        explicit CfgIndex(const json& root);
+        // tokenizes json text straight into the index, without building a
+        // document first. throws std::runtime_error on malformed input.
+        static CfgIndex parse(std::string_view text);
+        // the same for a document in any CfgFormat; binary formats are fed
+        // to the builder from nlohmann's SAX parser
+        static CfgIndex parse(std::string_view bytes, CfgFormat format);
+        // the same for the text of one value, indexed as if it sat at path
+        // (unescaped member names) in an otherwise empty document
+        static CfgIndex parse_at(std::string_view text, std::span<const std::string_view> path);
+
+        CfgIndex(CfgIndex&&) = default;
+        CfgIndex& operator=(CfgIndex&&) = default;
+        CfgIndex(const CfgIndex&) = delete;
+        CfgIndex& operator=(const CfgIndex&) = delete;
+
+        const CfgValue* find(std::string_view key) const noexcept;
+        const CfgValue* find(std::string_view key, uint64_t hash) const noexcept;
+        std::string_view str(const CfgValue& v) const noexcept {
+            return m_str_chars.substr(v.str.off, v.str.len);
+        }
+        const CfgValue& child(const CfgValue& container, uint32_t i) const noexcept {
+            return m_values[container.range.begin + i];
+        }
+        const CfgValue& root() const noexcept {
+            return m_values[m_root];
+        }
+        // views over a homogeneous array's typed pool; empty if the array is
+        // not made up of that type only
+        std::span<const int64_t> int_array(const CfgValue& arr) const noexcept;
+        std::span<const double> double_array(const CfgValue& arr) const noexcept;
+        std::span<const std::string_view> str_array(const CfgValue& arr) const noexcept;
+        // leaves whose key starts with prefix. the prefix is matched segment
+        // by segment up to its last '/', the rest against the member names
+        // (or array positions) there: "detail/appendix/" lists everything in
+        // appendix, "detail/lang" matches lang, lang-version and lang-patch.
+        // costs one lookup plus the container's children and the results.
+        CfgPathRange with_prefix(std::string_view prefix) const;
+        // key itself if it is a leaf, otherwise everything below it; empty
+        // if there is no such key
+        CfgPathRange subtree(std::string_view key) const;
+        size_t size() const noexcept { return m_values.size(); }
+        // v's slot in the value table, for side tables indexed like it
+        uint32_t position(const CfgValue& v) const noexcept {
+            return static_cast<uint32_t>(&v - m_values.data());
+        }
+        CfgMemoryUsage memory_usage() const noexcept;
+
+        // regenerate the document, or its json::flatten() form, for dumping
+        json to_json() const;
+        json to_flattened_json() const;
+        // streams the value at options.prefix to sink as json text, in
+        // document order, with at most one chunk buffered. false (and
+        // nothing written) if there is no such key.
+        bool dump(const CfgSink& sink, const CfgDumpOptions& options = {}) const;
+
+        // the arena is offset based, so it can be written out as is and
+        // mapped back in by another process. write_image() replaces the
+        // image atomically and throws std::runtime_error on I/O errors.
+        void write_image(const std::filesystem::path& image_path, const CfgImageKey& key) const;
+        // the same image written into memory; dst must hold image_size(key)
+        size_t image_size(const CfgImageKey& key) const noexcept;
+        void write_image(std::byte* dst, const CfgImageKey& key) const noexcept;
+        // maps an image and checks its format and section bounds; accept
+        // decides whether the source it was built from is still current.
+        // nullopt if the image is missing, malformed, not accepted, or not
+        // the user's own (see MappedFile::owned()).
+        static std::optional<CfgIndex> open_image(
+            const std::filesystem::path& image_path,
+            const std::function<bool(const CfgImageKey&)>& accept);
+        // same for an image that is already mapped; the index keeps it alive
+        static std::optional<CfgIndex> open_image(
+            std::shared_ptr<const MappedFile> image,
+            const std::function<bool(const CfgImageKey&)>& accept);
+
+        // deep-merges layers, bottom first, into one index: objects are
+        // merged member by member, anything else in a higher layer replaces
+        // the lower value whole. origins receives, by value position, the
+        // layer each merged value came from (for objects the topmost layer
+        // that has them).
+        static CfgIndex merge(std::span<const CfgIndex> layers, std::vector<uint16_t>& origins);
+
+    private:
+        struct KeyRef {
+            uint32_t off;
+            uint32_t len;
+        };
+        struct Slot {
+            uint32_t hash;
+            uint32_t value;
+        };
+        // where a value hangs in the tree: its container and, for object
+        // members, the interned segment of its name (npos for array elements)
+        struct Node {
+            uint32_t parent;
+            uint32_t seg;
+        };
+        // byte offsets of each arena section, relative to the arena start
+        struct Layout {
+            uint64_t size;
+            uint64_t root;
+            uint64_t value_count;
+            uint64_t slot_count;
+            uint64_t seg_count;
+            uint64_t str_ref_count;
+            uint64_t int_count;
+            uint64_t double_count;
+            uint64_t seg_chars_len;
+            uint64_t str_chars_len;
+            uint64_t values_off;
+            uint64_t nodes_off;
+            uint64_t slots_off;
+            uint64_t segs_off;
+            uint64_t str_refs_off;
+            uint64_t ints_off;
+            uint64_t doubles_off;
+            uint64_t seg_chars_off;
+            uint64_t str_chars_off;
+        };
+        struct ImageHeader;
+        class Merger;
+        class Dumper;
+        friend class CfgPathRange;
+
+        // owned arena when built in process, a mapped image otherwise
+        std::vector<std::byte, AlignedAllocator<std::byte>> m_arena;
+        std::shared_ptr<const MappedFile> m_image;
+        const std::byte* m_base = nullptr;
+        Layout m_layout {};
+        std::span<const CfgValue> m_values;
+        std::span<const Node> m_nodes;
+        std::span<const Slot> m_slots;
+        std::span<const KeyRef> m_segs;
+        // elements of homogeneous string arrays, in typed pool order
+        std::span<const KeyRef> m_str_refs;
+        std::span<const int64_t> m_int_pool;
+        std::span<const double> m_double_pool;
+        std::string_view m_seg_chars;
+        std::string_view m_str_chars;
+        // views of m_str_refs, made by the first str_array()
+        struct StrViews {
+            std::once_flag once;
+            std::vector<std::string_view> views;
+        };
+        std::unique_ptr<StrViews> m_str_views;
+        uint64_t m_mask = 0;
+        uint32_t m_root = 0;
+
+        CfgIndex() = default;
+        void attach(const std::byte* base, const Layout& layout);
+        ImageHeader image_header(const CfgImageKey& key) const noexcept;
+        // json pointer segment of a non-root value, escaped as in its path.
+        // array positions are written into buf.
+        std::string_view segment(uint32_t idx, char (&buf)[16]) const noexcept;
+        bool key_equals(uint32_t idx, std::string_view key) const noexcept;
+        json to_json(const CfgValue& v) const;
+        void flatten_into(json& flat, uint32_t idx, std::string& path) const;
+        void build_table(std::span<Slot> slots);
+    };
+
+    // receives a document as a stream of events and lays it out as a
+    // CfgIndex. completed children wait on a stack until their container
+    // closes and are then moved into the value table as one block.
+    class CfgIndex::Builder {
+    public:
+        Builder();
+
+        void begin_object();
+        void begin_array();
+        // unescaped member name; the next event is that member's value
+        void key(std::string_view name);
+        // the same for a name already escaped as a json pointer segment
+        void escaped_key(std::string_view segment);
+        void end_container();
+        void null_value();
+        void bool_value(bool b);
+        void int_value(int64_t i);
+        void uint_value(uint64_t u);
+        void double_value(double d);
+        void string_value(std::string_view s);
+
+        CfgIndex finish();
+
+    private:
+        // stores each distinct string once and hands out stable ids for it
+        class Interner {
+        public:
+            std::vector<char> chars;
+            std::vector<KeyRef> refs;
+
+            uint32_t intern(std::string_view s);
+
+        private:
+            std::vector<uint32_t> m_slots;
+            std::string_view at(uint32_t id) const noexcept {
+                return std::string_view(chars.data() + refs[id].off, refs[id].len);
+            }
+        };
+        struct Pending {
+            CfgValue value;
+            uint32_t seg;
+        };
+        struct Frame {
+            CfgType type;
+            uint32_t self_seg;
+            size_t pending_begin;
+        };
+
+        std::vector<CfgValue> m_values;
+        std::vector<uint32_t> m_value_segs;
+        Interner m_names;
+        Interner m_strings;
+        std::vector<Pending> m_pending;
+        std::vector<Frame> m_frames;
+        std::string m_scratch;
+        // per member name, where its last occurrence in the object being
+        // closed sits in m_pending
+        std::vector<size_t> m_last_member;
+        uint32_t m_key;
+        uint32_t m_root;
+        bool m_has_root;
+        // whether a repeated member name left an earlier value's subtree
+        // behind in m_values
+        bool m_dropped;
+
+        uint32_t next_seg();
+        void add(const CfgValue& v, uint32_t seg);
+        // removes the subtrees of values a repeated member name replaced
+        void drop_unreachable();
+        void begin_container(CfgType type);
+    };
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+#ifndef __CFG_KEY_H__
+#define __CFG_KEY_H__
+
+#include "cpptanu_cfg/cfg_index.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace tanu::cfg {
+
+    class JSONConfig;
+
+    // a key together with its cfg_key_hash(), for the getter overloads that
+    // skip hashing. "detail/lang"_cfgkey is checked and hashed at compile
+    // time; CfgHashedKey(key) hashes at run time. only the view is kept, so
+    // the key's characters must outlive it (literals always do).
+    class CfgHashedKey {
+    private:
+        std::string_view m_path;
+        uint64_t m_hash;
+    public:
+        constexpr explicit CfgHashedKey(std::string_view path) noexcept: m_path(path), m_hash(cfg_key_hash(path)) {}
+
+        constexpr std::string_view path() const noexcept {
+            return m_path;
+        }
+        constexpr uint64_t hash() const noexcept {
+            return m_hash;
+        }
+    };
+
+    inline namespace literals {
+        // the leading '/' is optional as for any key. an empty segment
+        // ("a//b"), a trailing '/' (which no getter would find) or a '~'
+        // that doesn't start ~0 or ~1 fails to compile.
+        consteval CfgHashedKey operator""_cfgkey(const char* chars, size_t len) {
+            const std::string_view path(chars, len);
+            if(path.size() > 1 && path.ends_with('/')) {
+                throw std::invalid_argument("config key with a trailing '/'");
+            }
+            for(size_t i = 0; i < path.size(); i++) {
+                if(path[i] == '/' && i + 1 < path.size() && path[i + 1] == '/') {
+                    throw std::invalid_argument("config key with an empty segment");
+                }
+                if(path[i] == '~' && (i + 1 == path.size() || (path[i + 1] != '0' && path[i + 1] != '1'))) {
+                    throw std::invalid_argument("config key with a stray '~'");
+                }
+            }
+            return CfgHashedKey(path);
+        }
+    }
+
+    // pre-resolved handle to a single value, obtained from JSONConfig::resolve().
+    // existence and type are checked once when resolving; get() is a plain
+    // load from the index. the handle keeps the index it was resolved against
+    // alive, so it keeps returning that version's value after a later load().
+    template<typename T>
+    class CfgKey {
+        static_assert(std::is_same_v<T, int> || std::is_same_v<T, double> || std::is_same_v<T, std::string>,
+            "CfgKey supports int, double and std::string");
+    private:
+        std::shared_ptr<const CfgIndex> m_index;
+        const CfgValue* m_value;
+
+        CfgKey(std::shared_ptr<const CfgIndex> index, const CfgValue* value): m_index(std::move(index)), m_value(value) {}
+        friend class JSONConfig;
+    public:
+        CfgKey(): m_index(nullptr), m_value(nullptr) {}
+
+        bool valid() const noexcept {
+            return m_value != nullptr;
+        }
+
+        // std::string handles return a view into the index instead of a copy
+        auto get() const noexcept {
+            if constexpr (std::is_same_v<T, int>) {
+                return static_cast<int>(m_value->i);
+            } else if constexpr (std::is_same_v<T, double>) {
+                return m_value->d;
+            } else {
+                return m_index->str(*m_value);
+            }
+        }
+
+        auto operator*() const noexcept {
+            return get();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef __CFG_LAZY_H__
+#define __CFG_LAZY_H__
+
+#include "cpptanu_cfg/cfg_index.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tanu::cfg {
+
+    // one member of the top-level object, or of an object-valued top-level
+    // member, located by a structural scan
+    struct CfgSectionSpan {
+        // unescaped member name
+        std::string name;
+        // the member's value, as it appears in the source text
+        std::string_view text;
+        // span of the enclosing top-level member, -1 at the top level
+        int32_t parent;
+    };
+
+    // finds the top-level and second-level members of an object document
+    // without parsing their values: strings and nesting are only skipped
+    // over, so malformed values surface when they are parsed. returns false
+    // if the document is not an object; throws std::runtime_error if the
+    // structure around the members is broken.
+    bool cfg_scan_sections(std::string_view text, std::vector<CfgSectionSpan>& out);
+
+    // a document that is indexed a section at a time. sections are the
+    // members of object-valued top-level members and the other top-level
+    // members as a whole; each one is parsed the first time a key under it
+    // is looked up. sections are indexed under their full paths, so their
+    // indexes answer the same keys as an index of the whole document.
+    class CfgLazyDocument {
+    public:
+        // scans source and keeps it, so sections never read the file again:
+        // rewriting the file in place can't change or pull away the bytes
+        // of sections not parsed yet
+        explicit CfgLazyDocument(std::string source);
+
+        // the index holding key, parsing its section first if needed; an
+        // empty index for keys in no section. thread-safe; throws
+        // std::runtime_error if the section is malformed.
+        const CfgIndex& index_for(std::string_view key) const;
+        // the whole document, parsed on first use
+        const CfgIndex& whole() const;
+        // sections materialized so far, plus the whole index if it was built
+        CfgMemoryUsage memory_usage() const noexcept;
+        size_t section_count() const noexcept {
+            return m_sections.size();
+        }
+        size_t materialized_count() const noexcept;
+
+    private:
+        struct Section {
+            std::string name;
+            // member of name for second-level sections, empty otherwise
+            std::string member;
+            bool nested;
+            std::string_view text;
+            std::mutex mtx;
+            std::unique_ptr<const CfgIndex> index;
+            std::atomic<const CfgIndex*> ready {nullptr};
+        };
+        struct SegmentHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view s) const noexcept {
+                return std::hash<std::string_view> {}(s);
+            }
+        };
+        template<typename T>
+        using SegmentMap = std::unordered_map<std::string, T, SegmentHash, std::equal_to<>>;
+        // a top-level member: a section itself, or split into its members'
+        struct Route {
+            uint32_t section = CfgIndex::npos;
+            SegmentMap<uint32_t> members;
+        };
+
+        const std::string m_source;
+        std::vector<std::unique_ptr<Section>> m_sections;
+        // keyed by json pointer segment
+        SegmentMap<Route> m_routes;
+        // false if the document is not an object; whole() serves every key
+        bool m_sectioned;
+        const CfgIndex m_empty;
+        mutable std::mutex m_whole_mtx;
+        mutable std::unique_ptr<const CfgIndex> m_whole;
+        mutable std::atomic<const CfgIndex*> m_whole_ready {nullptr};
+
+        const CfgIndex& materialize(Section& section) const;
+    };
+
+}
+
+#endif
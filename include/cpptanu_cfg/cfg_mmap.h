@@ -0,0 +1,45 @@
+#pragma once
+#ifndef __CFG_MMAP_H__
+#define __CFG_MMAP_H__
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace tanu::cfg {
+
+    // read-only view of a whole file, memory mapped where the platform
+    // allows it and read into memory otherwise
+    class MappedFile {
+    private:
+        const char* m_data;
+        size_t m_size;
+        bool m_owned;
+        std::string m_fallback;
+    public:
+        // sequential tells the kernel the file is read front to back once
+        explicit MappedFile(const std::filesystem::path& fpath, bool sequential = true);
+#ifdef __unix__
+        // maps all of an already open descriptor, e.g. a shared memory
+        // segment; the descriptor is not taken over. name is for errors only.
+        MappedFile(int fd, const std::string& name);
+#endif
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view bytes() const noexcept {
+            return std::string_view(m_data, m_size);
+        }
+        // whether the file belongs to the effective user and nobody else
+        // may write to it, so its content is as trustworthy as anything
+        // that user wrote; always true where files aren't mapped
+        bool owned() const noexcept {
+            return m_owned;
+        }
+    };
+
+}
+
+#endif
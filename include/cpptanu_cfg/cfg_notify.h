@@ -0,0 +1,69 @@
+#pragma once
+#ifndef __CFG_NOTIFY_H__
+#define __CFG_NOTIFY_H__
+
+#include "cpptanu_cfg/cfg_diff.h"
+#include "cpptanu_cfg/cfg_snapshot.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tanu::cfg {
+
+    // tells subscribers what changed between published versions. post()
+    // only hands the new snapshot over; the diff and the callbacks run on
+    // the notifier's own thread, so neither publishing nor getters wait on
+    // them. versions posted faster than they are dispatched are coalesced
+    // into one diff from the last dispatched version.
+    class CfgNotifier {
+    public:
+        using Callback = std::function<void(const CfgDiff&)>;
+
+        // base: the version subscribers have already seen, may be null
+        CfgNotifier(std::shared_ptr<const CfgSnapshot> base, uint64_t base_version);
+        // stops the thread; anything not dispatched yet is dropped
+        ~CfgNotifier();
+        CfgNotifier(const CfgNotifier&) = delete;
+        CfgNotifier& operator=(const CfgNotifier&) = delete;
+
+        // callback gets one batch per dispatch with the changes under
+        // prefix (see CfgDiff::under()), and none when there are none
+        uint64_t subscribe(std::string prefix, Callback callback);
+        // once it returns, the callback is not running and won't run again,
+        // unless it is called from a callback
+        void unsubscribe(uint64_t id);
+        void post(std::shared_ptr<const CfgSnapshot> snapshot, uint64_t version);
+        // waits until every version posted so far has been dispatched
+        void flush();
+
+    private:
+        struct Subscriber {
+            uint64_t id;
+            std::string prefix;
+            std::shared_ptr<const Callback> callback;
+        };
+
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        std::shared_ptr<const CfgSnapshot> m_latest;
+        uint64_t m_posted;
+        uint64_t m_dispatched;
+        std::vector<Subscriber> m_subscribers;
+        uint64_t m_next_id;
+        bool m_stop;
+        // held while callbacks run, so unsubscribe() can wait them out
+        std::mutex m_dispatch_mtx;
+        std::shared_ptr<const CfgSnapshot> m_base;
+        std::thread m_thread;
+
+        void run();
+    };
+
+}
+
+#endif
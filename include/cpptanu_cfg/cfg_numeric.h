@@ -0,0 +1,65 @@
+#pragma once
+#ifndef __CFG_NUMERIC_H__
+#define __CFG_NUMERIC_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <span>
+
+namespace tanu::cfg {
+
+    // instruction sets the bulk conversion kernels come in, lowest first
+    enum class CfgSimd : uint8_t {
+        Scalar,
+        Avx2,
+        Avx512
+    };
+
+    // the best level this CPU runs, detected once
+    CfgSimd cfg_simd_level() noexcept;
+    const char* cfg_simd_name(CfgSimd level) noexcept;
+
+    // element-wise conversion of in into out[0, in.size()), which must be
+    // large enough. level caps the kernel used; anything above what the CPU
+    // supports falls back to the best it does. conversions round like
+    // static_cast.
+    void cfg_convert(std::span<const double> in, float* out, CfgSimd level = cfg_simd_level()) noexcept;
+    void cfg_convert(std::span<const int64_t> in, double* out, CfgSimd level = cfg_simd_level()) noexcept;
+    void cfg_convert(std::span<const int64_t> in, float* out, CfgSimd level = cfg_simd_level()) noexcept;
+
+    // a fixed-size array on its own aligned allocation, e.g. for feeding
+    // aligned SIMD loads or device copies
+    template<typename T>
+    class CfgAlignedArray {
+    public:
+        CfgAlignedArray(): m_size(0) {}
+        // alignment: a power of two no smaller than alignof(T)
+        CfgAlignedArray(size_t size, size_t alignment):
+            m_data(static_cast<T*>(::operator new[](size * sizeof(T), std::align_val_t {alignment})), Deleter {alignment}),
+            m_size(size) {}
+
+        T* data() noexcept { return m_data.get(); }
+        const T* data() const noexcept { return m_data.get(); }
+        size_t size() const noexcept { return m_size; }
+        std::span<T> span() noexcept { return {m_data.get(), m_size}; }
+        std::span<const T> span() const noexcept { return {m_data.get(), m_size}; }
+        T& operator[](size_t i) noexcept { return m_data[i]; }
+        const T& operator[](size_t i) const noexcept { return m_data[i]; }
+
+    private:
+        struct Deleter {
+            size_t alignment;
+            void operator()(T* p) const noexcept {
+                ::operator delete[](p, std::align_val_t {alignment});
+            }
+        };
+        std::unique_ptr<T[], Deleter> m_data;
+        size_t m_size;
+    };
+
+}
+
+#endif
@@ -3,13 +3,33 @@
 #define __CFG_READ_H__
 
 #include "nlohmann/json/json.hpp"
+#include "cpptanu_cfg/cfg_bind.h"
+#include "cpptanu_cfg/cfg_dump.h"
+#include "cpptanu_cfg/cfg_error.h"
+#include "cpptanu_cfg/cfg_index.h"
+#include "cpptanu_cfg/cfg_key.h"
+#include "cpptanu_cfg/cfg_notify.h"
+#include "cpptanu_cfg/cfg_numeric.h"
+#include "cpptanu_cfg/cfg_registry.h"
+#include "cpptanu_cfg/cfg_schema.h"
+#include "cpptanu_cfg/cfg_snapshot.h"
+#include "cpptanu_cfg/cfg_stats.h"
 #include <string>
+#include <string_view>
 #include <memory>
 #include <cstdlib>
+#include <cstdint>
 #include <filesystem>
 #include <exception>
 #include <vector>
 #include <optional>
+#include <expected>
+#include <future>
+#include <span>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 using json = nlohmann::json;
 
@@ -21,34 +41,298 @@ namespace tanu::cfg {
     private:
         std::string m_group_name;
         std::string m_app_name;
-        std::unique_ptr<json> m_loaded_cfg;
-        std::unique_ptr<json> m_cfg_flattened_view;
         std::string conf_dir;
+        // readers check m_version against their thread's cached snapshot and
+        // only go to m_current (under m_publish_mtx) once per new version, so
+        // the steady-state read path writes nothing but thread-local memory.
+        // superseded snapshots are freed once the last thread that cached
+        // them moves on.
+        alignas(64) std::atomic<uint64_t> m_version;
+        const uint64_t m_instance_id;
+        // this config's entry in every thread's reader cache; no other live
+        // config shares it, and it is handed on once this one is destroyed
+        const size_t m_reader_slot;
+        alignas(64) mutable std::mutex m_publish_mtx;
+        std::shared_ptr<const CfgSnapshot> m_current;
+        std::optional<std::string> m_reload_error;
+        std::thread m_watcher;
+        int m_watch_stop_fd;
+        std::atomic<bool> m_use_image;
+        std::atomic<bool> m_use_shared;
+        std::atomic<bool> m_lazy;
+        std::atomic<bool> m_use_registry;
+        std::atomic<std::shared_ptr<const CfgSchema>> m_schema;
+        // null unless the library is built with TANU_CFG_STATS
+        std::unique_ptr<CfgStats> m_stats;
+        // created by the first subscribe(), under m_publish_mtx
+        std::unique_ptr<CfgNotifier> m_notifier;
+
+        const std::shared_ptr<const CfgSnapshot>& current() const;
+        const std::shared_ptr<const CfgSnapshot>& refresh(uint64_t version) const;
+        void publish(std::shared_ptr<const CfgSnapshot> snapshot);
+        void watch_loop(int inotify_fd, std::string file_name);
+        std::shared_ptr<const CfgSnapshot> read_snapshot(const std::filesystem::path& fpath) const;
+        // throws TanuCfgException listing the violations if a schema is set
+        // and snapshot doesn't conform to it
+        void check_schema(const CfgSnapshot& snapshot, std::string_view source) const;
+        static uint64_t next_instance_id();
+        static size_t acquire_reader_slot();
+        static void release_reader_slot(size_t slot) noexcept;
+        static std::unique_ptr<CfgStats> new_stats(uint64_t instance_id, size_t slot);
+        // the index answering key, parsing its section first in lazy mode
+        static const CfgIndex& index_for(const CfgSnapshot& snapshot, std::string_view key) {
+            return snapshot.lazy ? lazy_index_for(snapshot, key) : snapshot.index;
+        }
+        static const CfgIndex& lazy_index_for(const CfgSnapshot& snapshot, std::string_view key);
+        // as index_for(), but nullptr if the section is malformed
+        static const CfgIndex* try_index_for(const CfgSnapshot& snapshot, std::string_view key) noexcept;
+        static const CfgIndex& whole_index(const CfgSnapshot& snapshot);
+        static const CfgValue* find_leaf(const CfgIndex& index, std::string_view key, uint64_t hash) noexcept;
+        static const CfgValue* find_array(const CfgIndex& index, std::string_view key, uint64_t hash) noexcept;
+        static const CfgValue& lookup(const CfgIndex& index, std::string_view key, uint64_t hash);
+        static const CfgValue& lookup_array(const CfgIndex& index, std::string_view key, uint64_t hash);
+        static bool has_value(const CfgIndex& index, std::string_view key, uint64_t hash);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, int& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, int64_t& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, uint64_t& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, double& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, bool& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::string& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::string_view& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<int>& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<int64_t>& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<double>& out);
+        static void read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<std::string>& out);
+        // the typed pool of the numeric array at key; doubles stay empty
+        // when integral. throws like the vector getters.
+        static std::pair<std::span<const int64_t>, std::span<const double>> numeric_array(const CfgIndex& index, std::string_view key, bool integral);
+        template<typename S, typename T>
+        static void read_field(const CfgIndex& index, const CfgField<S, T>& field, S& out);
+        // the shared body of the try_get_as_* family, as read_value() is of
+        // get_as_*: finds the leaf of Type (any integer for CfgType::Int),
+        // or the array for CfgType::Array, at key and hands it to extract.
+        // an empty span from extract means the elements had another type.
+        template<CfgType Type, typename T, typename Extract>
+        std::expected<T, CfgError> try_read(CfgHashedKey hashed, const char* expected, Extract extract);
     public:
         JSONConfig(
-            const std::string& group_name, 
-            const std::string& app_name): m_group_name(group_name), m_app_name(app_name), m_loaded_cfg(nullptr), m_cfg_flattened_view(nullptr) {
+            const std::string& group_name,
+            const std::string& app_name): m_group_name(group_name), m_app_name(app_name), m_version(0), m_instance_id(next_instance_id()), m_reader_slot(acquire_reader_slot()), m_current(nullptr), m_watch_stop_fd(-1), m_use_image(false), m_use_shared(false), m_lazy(false), m_use_registry(false), m_stats(new_stats(m_instance_id, m_reader_slot)) {
                 std::string conf_base {getenv(CONF_DIR_ENV_VAR_NAME.c_str())};
                 conf_dir = (std::filesystem::path(conf_base) / m_group_name / m_app_name).string();
             }
-        ~JSONConfig() {
-            if(m_loaded_cfg != nullptr) {
-                m_loaded_cfg.release();
-                m_loaded_cfg = nullptr;
-                m_cfg_flattened_view.release();
-                m_cfg_flattened_view = nullptr;
-            }
-        }
-        
+        ~JSONConfig();
+
         std::optional<std::string> dump_cfg();
         std::optional<std::string> dump_flattened_view();
+        // the same without building the document or its text in memory:
+        // streams the current version, or the value at options.prefix, to
+        // sink in chunks (see CfgDumpOptions). in lazy mode a prefix inside
+        // one section only parses that section. false if nothing is loaded
+        // or there is no such key.
+        bool dump(const CfgSink& sink, const CfgDumpOptions& options = {});
+        bool dump(std::ostream& out, const CfgDumpOptions& options = {});
+        bool dump(int fd, const CfgDumpOptions& options = {});
         void load(const std::string& cfg_file_name);
+        // load() on a thread of its own. the future rethrows its
+        // TanuCfgException; the config must outlive it. see cfg_batch.h for
+        // loading many configs at once.
+        std::future<void> load_async(const std::string& cfg_file_name);
+        // loads an ordered stack of files from the config dir, e.g.
+        // {"base.json", "region.json", "host.json"}. they are parsed in
+        // parallel and deep-merged once into a single index, later files
+        // overriding earlier ones key by key; arrays and scalars are replaced
+        // whole. getters cost the same as after load().
+        void load_layers(const std::vector<std::string>& cfg_file_names);
+        // the layer file that supplied key's value after load_layers();
+        // nullopt for a missing key or a single-file load
+        std::optional<std::string> provenance(std::string_view key);
+        // when enabled, load() and reloads keep a compiled binary image next
+        // to the config file (see cfg_image.h) and map it instead of parsing
+        // for as long as the file is unchanged. off by default.
+        void set_compiled_cache(bool enabled) noexcept {
+            m_use_image.store(enabled, std::memory_order_relaxed);
+        }
+        // when enabled, load() and reloads serve the config from a POSIX
+        // shared memory image that all processes on the host map read-only
+        // (see cfg_shm.h). the first process to find it missing or stale
+        // publishes a new generation; the others attach to it. takes
+        // precedence over the compiled cache. off by default.
+        void set_shared_memory(bool enabled) noexcept {
+            m_use_shared.store(enabled, std::memory_order_relaxed);
+        }
+        // when enabled, load() and reloads only scan the file for its
+        // sections (the members of top-level objects, and other top-level
+        // members) and parse each one the first time a getter reads a key in
+        // it, so startup cost follows what the process reads rather than the
+        // file size. the file is read into memory first, so rewriting it in
+        // place never changes a loaded version. a malformed section is only
+        // reported then, as the getter's TanuCfgException. dumps and the
+        // prefix/subtree views parse the whole file. the compiled cache and
+        // shared memory take precedence. off by default.
+        void set_lazy_sections(bool enabled) noexcept {
+            m_lazy.store(enabled, std::memory_order_relaxed);
+        }
+        // when enabled, load() and reloads go through the process-wide
+        // CfgRegistry (cfg_registry.h): configs of the same unchanged file,
+        // loaded in the same mode, share one immutable snapshot, and
+        // concurrent first loads of it parse the file once. off by default.
+        void set_shared_registry(bool enabled) noexcept {
+            m_use_registry.store(enabled, std::memory_order_relaxed);
+        }
+        // checks every later load(), load_layers() and reload against schema
+        // (see cfg_schema.h) in one pass before it is published. a version
+        // that doesn't conform is rejected like one that fails to parse,
+        // with the violations in the message; lazy sections are parsed whole
+        // for it. nullptr turns validation off.
+        void set_schema(std::shared_ptr<const CfgSchema> schema) noexcept {
+            m_schema.store(std::move(schema), std::memory_order_release);
+        }
+        // compiles the JSON Schema file in the config dir and sets it
+        void load_schema(const std::string& schema_file_name);
+        // loads cfg_file_name, then keeps reloading it in the background
+        // whenever it is rewritten or replaced. a file that fails to parse
+        // leaves the previous version live and is reported by
+        // last_reload_error().
+        void watch(const std::string& cfg_file_name);
+        void unwatch();
+        // bumped every time a new version is published
+        uint64_t version() const noexcept {
+            return m_version.load(std::memory_order_acquire);
+        }
+        std::optional<std::string> last_reload_error();
+        // calls callback with the keys added, removed and changed under
+        // prefix (see CfgDiff) each time load() or a reload publishes a new
+        // version. callbacks run one batch per version on a notifier thread
+        // of this config, never on the loading thread, and getters don't
+        // wait for them. returns an id for unsubscribe().
+        uint64_t subscribe(std::string prefix, CfgNotifier::Callback callback);
+        void unsubscribe(uint64_t id);
+        // waits until subscribers have been told about every version
+        // published so far
+        void flush_notifications();
+        // bytes held by the current version; all zero before the first load
+        CfgMemoryUsage memory_usage();
+        // per-key hit/miss counts and getter and load phase latencies
+        // gathered so far; empty unless cfg_stats_enabled()
+        CfgStatsSnapshot stats() const;
+        // shared ownership of the current version. unlike the getters this
+        // bumps a shared reference count, so keep it off hot paths.
+        std::shared_ptr<const CfgSnapshot> snapshot();
+        // every getter also takes a CfgHashedKey, e.g. "detail/lang"_cfgkey
+        // (see cfg_key.h), and then looks it up by the precomputed hash
+        // instead of hashing the key on each call
         int get_as_int(const std::string& key);
+        int get_as_int(std::string_view key);
+        int get_as_int(CfgHashedKey key);
+        int get_as_int(const char* key);
         std::string get_as_str(const std::string& key);
+        std::string get_as_str(std::string_view key);
+        std::string get_as_str(CfgHashedKey key);
+        std::string get_as_str(const char* key);
         double get_as_double(const std::string& key);
+        double get_as_double(std::string_view key);
+        double get_as_double(CfgHashedKey key);
+        double get_as_double(const char* key);
         std::vector<int> get_as_int_vec(const std::string& key);
+        std::vector<int> get_as_int_vec(std::string_view key);
+        std::vector<int> get_as_int_vec(CfgHashedKey key);
+        std::vector<int> get_as_int_vec(const char* key);
         std::vector<std::string> get_as_str_vec(const std::string& key);
+        std::vector<std::string> get_as_str_vec(std::string_view key);
+        std::vector<std::string> get_as_str_vec(CfgHashedKey key);
+        std::vector<std::string> get_as_str_vec(const char* key);
         std::vector<double> get_as_double_vec(const std::string& key);
+        std::vector<double> get_as_double_vec(std::string_view key);
+        std::vector<double> get_as_double_vec(CfgHashedKey key);
+        std::vector<double> get_as_double_vec(const char* key);
+        // get_as_int() throws outside the int range; these read the full
+        // width. uint64 takes non-negative integers, int64 throws above
+        // INT64_MAX, float rounds a double.
+        int64_t get_as_int64(std::string_view key);
+        int64_t get_as_int64(CfgHashedKey key);
+        uint64_t get_as_uint64(std::string_view key);
+        uint64_t get_as_uint64(CfgHashedKey key);
+        float get_as_float(std::string_view key);
+        float get_as_float(CfgHashedKey key);
+        bool get_as_bool(std::string_view key);
+        bool get_as_bool(CfgHashedKey key);
+        // bulk export of the numeric array at key into out, converted to T
+        // (float, double or int64_t; integer arrays only for int64_t) by
+        // vectorized kernels (see cfg_numeric.h). returns the element count;
+        // throws if out is too small.
+        template<typename T>
+        size_t copy_as(std::string_view key, std::span<T> out);
+        // the same into a new buffer aligned to alignment bytes
+        template<typename T>
+        CfgAlignedArray<T> copy_as_aligned(std::string_view key, size_t alignment = 64);
+        // zero-copy views over homogeneous arrays. they stay valid until the
+        // calling thread reads this config again after a load() or reload;
+        // hold on to snapshot() to keep a version alive for longer.
+        std::span<const int64_t> get_as_int_span(std::string_view key);
+        std::span<const int64_t> get_as_int_span(CfgHashedKey key);
+        std::span<const double> get_as_double_span(std::string_view key);
+        std::span<const double> get_as_double_span(CfgHashedKey key);
+        std::span<const std::string_view> get_as_str_span(std::string_view key);
+        std::span<const std::string_view> get_as_str_span(CfgHashedKey key);
+        // get_as_str() without the copy: string leaves are interned once per
+        // version, so equal values share their bytes and this is a view of
+        // them, with the same lifetime as the spans
+        std::string_view get_as_str_view(std::string_view key);
+        std::string_view get_as_str_view(CfgHashedKey key);
+        // getters without the lookup checks, for keys the schema set before
+        // load() guarantees (see CfgSchema::guarantees(), worth checking once
+        // at startup): required all the way down and of type integer
+        // (int64_t, saturating above INT64_MAX), number (double), boolean
+        // (bool) or string (std::string_view, which lives as long as the
+        // spans). any other key is undefined behaviour. they don't throw, so
+        // load() must have succeeded first: reading an unloaded config
+        // terminates, as does running out of memory on a thread's first read.
+        template<typename T>
+        T get_unchecked(std::string_view key) noexcept;
+        template<typename T>
+        T get_unchecked(CfgHashedKey key) noexcept;
+        // lazy views of the current version, with the same lifetime as the
+        // spans above. keys_with_prefix() yields the json pointer keys that
+        // start with prefix, subtree() every leaf and value below key; see
+        // CfgIndex::with_prefix() for how a prefix is matched.
+        CfgKeyRange keys_with_prefix(std::string_view prefix);
+        CfgPathRange subtree(std::string_view key);
+        // element count of the array at key; throws if there is none
+        size_t array_size(std::string_view key);
+        // non-throwing lookups for optional keys on hot paths: a missing key,
+        // a type mismatch or an integer outside int comes back as a CfgError,
+        // without unwinding or allocating. Strings and arrays are views with
+        // the same lifetime as the span getters, and the error refers to the
+        // key passed in.
+        std::expected<int, CfgError> try_get_as_int(std::string_view key);
+        std::expected<int, CfgError> try_get_as_int(CfgHashedKey key);
+        std::expected<double, CfgError> try_get_as_double(std::string_view key);
+        std::expected<double, CfgError> try_get_as_double(CfgHashedKey key);
+        std::expected<std::string_view, CfgError> try_get_as_str(std::string_view key);
+        std::expected<std::string_view, CfgError> try_get_as_str(CfgHashedKey key);
+        std::expected<std::span<const int64_t>, CfgError> try_get_as_int_span(std::string_view key);
+        std::expected<std::span<const int64_t>, CfgError> try_get_as_int_span(CfgHashedKey key);
+        std::expected<std::span<const double>, CfgError> try_get_as_double_span(std::string_view key);
+        std::expected<std::span<const double>, CfgError> try_get_as_double_span(CfgHashedKey key);
+        std::expected<std::span<const std::string_view>, CfgError> try_get_as_str_span(std::string_view key);
+        std::expected<std::span<const std::string_view>, CfgError> try_get_as_str_span(CfgHashedKey key);
+        // default_value when the key is missing, mistyped or nothing is loaded
+        int get_or(std::string_view key, int default_value);
+        double get_or(std::string_view key, double default_value);
+        std::string_view get_or(std::string_view key, std::string_view default_value);
+        template<typename T>
+        CfgKey<T> resolve(std::string_view key);
+        // fills every member declared in CfgBinding<S> from one version of
+        // the config, with the same errors as the matching getters
+        template<CfgBindable S>
+        void bind(S& out);
+        template<CfgBindable S>
+        S bind() {
+            S out {};
+            bind(out);
+            return out;
+        }
     };
 
     class TanuCfgException:public std::exception {
@@ -61,7 +345,28 @@ namespace tanu::cfg {
         }
     };
 
+    template<typename S, typename T>
+    void JSONConfig::read_field(const CfgIndex& index, const CfgField<S, T>& field, S& out) {
+        T& member = out.*(field.member);
+        if constexpr (cfg_bindable_value<T>) {
+            read_value(index, field.path, field.hash, member);
+        } else if(has_value(index, field.path, field.hash)) {
+            read_value(index, field.path, field.hash, member.emplace());
+        } else {
+            member.reset();
+        }
+    }
+
+    template<CfgBindable S>
+    void JSONConfig::bind(S& out) {
+        static_assert(cfg_paths_unique(CfgBinding<S>::fields), "CfgBinding binds a path twice");
+        const std::shared_ptr<const CfgSnapshot>& snapshot = current();
+        std::apply([&](const auto&... field) {
+            (read_field(index_for(*snapshot, field.path), field, out), ...);
+        }, CfgBinding<S>::fields);
+    }
+
 }
 
 
-#endif
\ No newline at end of file
+#endif
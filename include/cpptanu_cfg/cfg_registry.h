@@ -0,0 +1,83 @@
+#pragma once
+#ifndef __CFG_REGISTRY_H__
+#define __CFG_REGISTRY_H__
+
+#include "cpptanu_cfg/cfg_snapshot.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace tanu::cfg {
+
+    // how a snapshot was built from its file; snapshots of the same file
+    // built in different modes are not interchangeable
+    enum class CfgLoadMode : uint8_t {
+        Parse,
+        Image,
+        Shared,
+        Lazy
+    };
+
+    // identity of a file's content on disk. rewriting or replacing the file
+    // changes at least one of these.
+    struct CfgFileId {
+        uint64_t device;
+        uint64_t inode;
+        uint64_t size;
+        int64_t mtime_ns;
+
+        bool operator==(const CfgFileId&) const = default;
+        // throws std::runtime_error if fpath can't be stat'ed
+        static CfgFileId of(const std::filesystem::path& fpath);
+    };
+
+    // process-wide cache of the snapshots JSONConfig instances have loaded,
+    // keyed by canonical path and load mode. a request whose file still has
+    // the identity of a live snapshot gets that snapshot; concurrent first
+    // requests for the same file wait for a single load. entries only hold
+    // weak references, so a snapshot is freed with its last config.
+    class CfgRegistry {
+    public:
+        using Loader = std::function<std::shared_ptr<const CfgSnapshot>()>;
+
+        static CfgRegistry& instance();
+
+        // the live snapshot of fpath for mode, or the one load() builds.
+        // load() errors are rethrown to every caller that waited for them;
+        // the next request tries again.
+        std::shared_ptr<const CfgSnapshot> acquire(const std::filesystem::path& fpath, CfgLoadMode mode, const Loader& load);
+        // loads run so far, i.e. requests that could not share a snapshot
+        uint64_t load_count() const noexcept {
+            return m_loads.load(std::memory_order_relaxed);
+        }
+        // entries whose snapshot is still alive or loading
+        size_t live_count() const;
+
+    private:
+        using Pending = std::shared_future<std::shared_ptr<const CfgSnapshot>>;
+        struct Entry {
+            CfgFileId id {};
+            std::weak_ptr<const CfgSnapshot> snapshot;
+            // valid while a load is in flight
+            Pending pending;
+            // tells a finishing load whether the entry was taken over since
+            uint64_t generation = 0;
+        };
+
+        mutable std::mutex m_mtx;
+        std::map<std::pair<std::string, CfgLoadMode>, Entry> m_entries;
+        std::atomic<uint64_t> m_loads {0};
+
+        CfgRegistry() = default;
+    };
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef __CFG_SCHEMA_H__
+#define __CFG_SCHEMA_H__
+
+#include "nlohmann/json/json.hpp"
+#include "cpptanu_cfg/cfg_index.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace tanu::cfg {
+
+    // json types a schema can allow, as bits
+    enum CfgSchemaType : uint8_t {
+        SchemaNull = 1 << 0,
+        SchemaBoolean = 1 << 1,
+        SchemaInteger = 1 << 2,
+        // "number" also allows integers
+        SchemaDouble = 1 << 3,
+        SchemaString = 1 << 4,
+        SchemaArray = 1 << 5,
+        SchemaObject = 1 << 6,
+        SchemaAny = 0x7f
+    };
+
+    // a JSON Schema subset compiled into a flat rule table:
+    //   type (one name or a list), properties, required, items (one schema
+    //   for every element), minimum, maximum, exclusiveMinimum,
+    //   exclusiveMaximum, minItems, maxItems.
+    // other keywords are ignored. rules outside any "items" carry their
+    // full key and its hash, so checking them costs one index probe each;
+    // rules under "items" run once per element.
+    class CfgSchema {
+    public:
+        // throws std::runtime_error on a malformed schema
+        static CfgSchema compile(const json& schema);
+
+        // every violation in index, as "<key>: <what>", stopping after
+        // max_errors; empty when index conforms
+        std::vector<std::string> validate(const CfgIndex& index, size_t max_errors = 16) const;
+        // true if any index this schema accepts has key, outside any array,
+        // holding only types from the mask: key and all its parents are
+        // required, and key allows nothing but those types
+        bool guarantees(std::string_view key, uint8_t types) const;
+        size_t rule_count() const noexcept {
+            return m_rules.size();
+        }
+
+    private:
+        static constexpr uint32_t npos = UINT32_MAX;
+        struct Rule {
+            // full key outside items, the segment(s) below the parent inside
+            std::string key;
+            uint64_t hash;
+            bool absolute;
+            bool required;
+            uint8_t types;
+            bool exclusive_min;
+            bool exclusive_max;
+            double minimum;
+            double maximum;
+            uint64_t min_items;
+            uint64_t max_items;
+            uint32_t items;
+            // properties: m_children[children_begin, children_end)
+            uint32_t children_begin;
+            uint32_t children_end;
+        };
+        struct Errors {
+            std::vector<std::string> list;
+            size_t max;
+            bool full() const noexcept {
+                return list.size() >= max;
+            }
+        };
+
+        std::vector<Rule> m_rules;
+        std::vector<uint32_t> m_children;
+        // required chains outside items, by key, with their allowed types
+        std::unordered_map<std::string, uint8_t> m_guaranteed;
+
+        uint32_t compile_rule(const json& schema, std::string key, bool absolute, bool required, bool guaranteed);
+        void check(const CfgIndex& index, uint32_t r, const CfgValue& v, const std::string& path, Errors& errors) const;
+    };
+
+}
+
+#endif
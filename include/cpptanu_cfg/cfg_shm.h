@@ -0,0 +1,63 @@
+#pragma once
+#ifndef __CFG_SHM_H__
+#define __CFG_SHM_H__
+
+#include "cpptanu_cfg/cfg_mmap.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace tanu::cfg {
+
+    // the POSIX shared memory segments one config file is published in. a
+    // small control segment, named after the file's absolute path, holds the
+    // current generation; each generation's compiled image lives in a segment
+    // of its own. readers map an image read-only, so every process of the
+    // same user on the host serves lookups from the same pages. segments are
+    // created 0600, and ones owned by another user are never used.
+    //
+    // lock()/unlock() serialize publishers across processes, so this can be
+    // used with std::lock_guard. constructing throws std::system_error when
+    // shared memory is unavailable or not permitted, or the control segment
+    // belongs to another user.
+    class CfgSharedSegments {
+    private:
+        struct Control {
+            std::atomic<uint64_t> generation;
+        };
+        static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+        std::string m_name;
+        int m_control_fd;
+        Control* m_control;
+
+        std::string segment_name(uint64_t generation) const;
+    public:
+        explicit CfgSharedSegments(const std::filesystem::path& source);
+        ~CfgSharedSegments();
+        CfgSharedSegments(const CfgSharedSegments&) = delete;
+        CfgSharedSegments& operator=(const CfgSharedSegments&) = delete;
+
+        // 0 until something is published
+        uint64_t generation() const noexcept;
+        // read-only mapping of a generation's image; nullptr if it is gone
+        std::shared_ptr<const MappedFile> map(uint64_t generation) const;
+        // creates the next generation, lets fill write its size bytes and
+        // makes it current. the previous segment is unlinked; processes that
+        // still map it keep their pages until they move on.
+        uint64_t publish(size_t size, const std::function<void(std::byte*)>& fill);
+
+        void lock();
+        void unlock();
+
+        // removes the control segment and the current generation
+        static void unlink(const std::filesystem::path& source);
+    };
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef __CFG_SNAPSHOT_H__
+#define __CFG_SNAPSHOT_H__
+
+#include "cpptanu_cfg/cfg_index.h"
+#include "cpptanu_cfg/cfg_lazy.h"
+#include "cpptanu_cfg/cfg_stats.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tanu::cfg {
+
+    // one fully built, immutable version of a config file. JSONConfig
+    // publishes these by pointer swap; nothing inside is modified afterwards.
+    struct CfgSnapshot {
+        const CfgIndex index;
+        // layered configs only: the layer files, bottom first, and by value
+        // position the layer each value of index came from
+        const std::vector<std::string> layers;
+        const std::vector<uint16_t> origins;
+        // lazy loads only: the sections parsed so far. index is empty then;
+        // go through index_for() and whole() instead.
+        const std::unique_ptr<const CfgLazyDocument> lazy;
+
+        explicit CfgSnapshot(CfgIndex&& built): index(std::move(built)) {}
+        CfgSnapshot(CfgIndex&& merged, std::vector<std::string> layer_names, std::vector<uint16_t> value_origins):
+            index(std::move(merged)), layers(std::move(layer_names)), origins(std::move(value_origins)) {}
+        explicit CfgSnapshot(std::unique_ptr<const CfgLazyDocument> document):
+            index(CfgIndex::parse("{}")), lazy(std::move(document)) {}
+
+        // the index that answers key
+        const CfgIndex& index_for(std::string_view key) const {
+            return lazy ? lazy->index_for(key) : index;
+        }
+        // the index of the whole document
+        const CfgIndex& whole() const {
+            return lazy ? lazy->whole() : index;
+        }
+
+        // maps fpath and indexes it in one pass; throws on I/O or parse errors.
+        // with use_image, a compiled image next to fpath is mapped instead
+        // while it is current, and (re)written after every parse. phases, if
+        // given, accumulates the time spent in each step.
+        static std::shared_ptr<const CfgSnapshot> from_file(const std::filesystem::path& fpath, bool use_image = false, CfgLoadPhases* phases = nullptr);
+        // serves fpath from the host-wide shared memory image (cfg_shm.h),
+        // publishing a new generation first if there is none or it is stale.
+        // falls back to from_file() where shared memory can't be used.
+        static std::shared_ptr<const CfgSnapshot> from_shared(const std::filesystem::path& fpath, CfgLoadPhases* phases = nullptr);
+        // reads fpath into memory and only scans it; sections are parsed as
+        // they are first read (see CfgLazyDocument)
+        static std::shared_ptr<const CfgSnapshot> from_file_lazy(const std::filesystem::path& fpath, CfgLoadPhases* phases = nullptr);
+        // parses every layer on its own thread and deep-merges them, bottom
+        // first, with CfgIndex::merge()
+        static std::shared_ptr<const CfgSnapshot> from_layers(const std::vector<std::filesystem::path>& fpaths, CfgLoadPhases* phases = nullptr);
+    };
+
+}
+
+#endif
@@ -0,0 +1,208 @@
+#pragma once
+#ifndef __CFG_STATS_H__
+#define __CFG_STATS_H__
+
+#include "nlohmann/json/json.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace tanu::cfg {
+
+    // latency distribution in power-of-two buckets: bucket b counts samples
+    // in [2^(b-1), 2^b) ns, bucket 0 the ones that took 0 ns
+    struct CfgLatencyHistogram {
+        static constexpr size_t BUCKETS = 40;
+
+        std::array<uint64_t, BUCKETS> buckets {};
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+
+        void add(uint64_t ns) noexcept {
+            buckets[std::min<size_t>(std::bit_width(ns), BUCKETS - 1)]++;
+            count++;
+            total_ns += ns;
+            max_ns = std::max(max_ns, ns);
+        }
+        void merge(const CfgLatencyHistogram& other) noexcept;
+        // upper bound of the bucket holding the q-th quantile, q in [0, 1]
+        uint64_t percentile(double q) const noexcept;
+        json to_json() const;
+    };
+
+    struct CfgKeyStats {
+        // json pointer form
+        std::string key;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    // point-in-time copy of everything CfgStats collected
+    struct CfgStatsSnapshot {
+        // most accessed first
+        std::vector<CfgKeyStats> keys;
+        // by getter name, e.g. "get_as_int"
+        std::map<std::string, CfgLatencyHistogram> getters;
+        // by load phase: read, parse, image, publish
+        std::map<std::string, CfgLatencyHistogram> load_phases;
+
+        json to_json() const;
+    };
+
+    enum class CfgGetter : uint8_t {
+        Int,
+        Str,
+        Double,
+        IntVec,
+        StrVec,
+        DoubleVec,
+        IntSpan,
+        DoubleSpan,
+        StrSpan,
+        TryInt,
+        TryDouble,
+        TryStr,
+        TryIntSpan,
+        TryDoubleSpan,
+        TryStrSpan,
+        StrView,
+        Int64,
+        UInt64,
+        Float,
+        Bool,
+        CopyAs,
+        Unchecked,
+        Count
+    };
+
+    enum class CfgLoadPhase : uint8_t {
+        // mapping the source and hashing it for the image checks
+        Read,
+        // tokenizing and indexing
+        Parse,
+        // opening, writing, attaching or publishing a compiled image
+        Image,
+        // checking the new version against the schema, if one is set
+        Validate,
+        // swapping the new version in
+        Publish,
+        Count
+    };
+
+    // wall time one snapshot build spent in each phase
+    struct CfgLoadPhases {
+        uint64_t read_ns = 0;
+        uint64_t parse_ns = 0;
+        uint64_t image_ns = 0;
+    };
+
+    // whether the library was built with TANU_CFG_STATS
+    bool cfg_stats_enabled() noexcept;
+
+    // access counters and latency histograms of one JSONConfig. every
+    // thread records into its own shard, so getters on different threads
+    // never share a lock or a cache line; snapshot() merges the shards.
+    //
+    // the recording hooks below only exist when the library is built with
+    // TANU_CFG_STATS (make STATS=1); otherwise JSONConfig never creates
+    // one of these and the hooks expand to nothing.
+    class CfgStats {
+    private:
+        struct KeyHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view key) const noexcept {
+                return std::hash<std::string_view> {}(key);
+            }
+        };
+        // the counters of a shard are only written by the thread that owns
+        // it, with relaxed load/store pairs, so recording never locks;
+        // snapshot() reads them with relaxed loads while getters run
+        struct KeyCounters {
+            std::atomic<uint64_t> hits {0};
+            std::atomic<uint64_t> misses {0};
+        };
+        struct SharedHistogram {
+            std::array<std::atomic<uint64_t>, CfgLatencyHistogram::BUCKETS> buckets {};
+            std::atomic<uint64_t> count {0};
+            std::atomic<uint64_t> total_ns {0};
+            std::atomic<uint64_t> max_ns {0};
+
+            void add(uint64_t ns) noexcept;
+            CfgLatencyHistogram load() const noexcept;
+        };
+        struct alignas(64) Shard {
+            // held by the owner only while it adds a key, and by snapshot()
+            std::mutex mtx;
+            std::unordered_map<std::string, KeyCounters, KeyHash, std::equal_to<>> keys;
+            std::array<SharedHistogram, static_cast<size_t>(CfgGetter::Count)> getters;
+        };
+
+        const uint64_t m_instance_id;
+        // the owning config's reader slot, which indexes the per-thread
+        // shard cache the same way it indexes the reader cache
+        const size_t m_slot;
+        mutable std::mutex m_mtx;
+        std::vector<std::unique_ptr<Shard>> m_shards;
+        std::array<CfgLatencyHistogram, static_cast<size_t>(CfgLoadPhase::Count)> m_phases;
+
+        Shard& local_shard();
+        Shard& register_shard();
+    public:
+        CfgStats(uint64_t instance_id, size_t slot): m_instance_id(instance_id), m_slot(slot) {}
+
+        // times one getter call; a call that leaves by exception or is
+        // marked with miss() counts as a miss of its key
+        class Scope {
+        private:
+            CfgStats& m_stats;
+            const CfgGetter m_getter;
+            const std::string_view m_key;
+            const int m_uncaught;
+            bool m_missed;
+            const std::chrono::steady_clock::time_point m_start;
+        public:
+            Scope(CfgStats& stats, CfgGetter getter, std::string_view key) noexcept:
+                m_stats(stats), m_getter(getter), m_key(key), m_uncaught(std::uncaught_exceptions()),
+                m_missed(false), m_start(std::chrono::steady_clock::now()) {}
+            ~Scope();
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            void miss() noexcept {
+                m_missed = true;
+            }
+        };
+
+        void record(CfgGetter getter, std::string_view key, bool hit, uint64_t ns);
+        void record_phase(CfgLoadPhase phase, uint64_t ns);
+        void record_load(const CfgLoadPhases& phases);
+        CfgStatsSnapshot snapshot() const;
+    };
+
+}
+
+#ifdef TANU_CFG_STATS
+#define TANU_CFG_STATS_SCOPE(stats, getter, key) \
+    ::tanu::cfg::CfgStats::Scope tanu_cfg_stats_scope(*(stats), ::tanu::cfg::CfgGetter::getter, key)
+#define TANU_CFG_STATS_MISS() \
+    tanu_cfg_stats_scope.miss()
+#else
+#define TANU_CFG_STATS_SCOPE(stats, getter, key)
+#define TANU_CFG_STATS_MISS()
+#endif
+
+#endif
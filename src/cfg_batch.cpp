@@ -0,0 +1,44 @@
+#include "cpptanu_cfg/cfg_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace tanu::cfg {
+
+    std::vector<CfgLoadResult> cfg_load_all(std::span<const CfgLoadRequest> requests, size_t max_threads) {
+        std::vector<CfgLoadResult> results(requests.size());
+        if(max_threads == 0) {
+            max_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        // workers claim requests in order until none are left
+        std::atomic<size_t> next {0};
+        auto work = [&] {
+            for(size_t i = next.fetch_add(1); i < requests.size(); i = next.fetch_add(1)) {
+                const CfgLoadRequest& req = requests[i];
+                CfgLoadResult& rez = results[i];
+                try {
+                    rez.config = std::make_unique<JSONConfig>(req.group, req.app);
+                    rez.config->load(req.file);
+                } catch(const std::exception& e) {
+                    rez.error = e.what();
+                } catch(...) {
+                    rez.error = "unknown error";
+                }
+            }
+        };
+
+        const size_t n_threads = std::min(max_threads, requests.size());
+        std::vector<std::thread> workers;
+        for(size_t t = 1; t < n_threads; t++) {
+            workers.emplace_back(work);
+        }
+        // the calling thread takes a share instead of idling in join()
+        work();
+        for(std::thread& w : workers) {
+            w.join();
+        }
+        return results;
+    }
+
+}
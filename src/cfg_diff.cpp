@@ -0,0 +1,80 @@
+#include "cpptanu_cfg/cfg_diff.h"
+
+namespace tanu::cfg {
+
+    namespace {
+        bool same_leaf(const CfgIndex& a, const CfgValue& va, const CfgIndex& b, const CfgValue& vb) {
+            if(va.type != vb.type) {
+                return false;
+            }
+            switch(va.type) {
+                case CfgType::Null:
+                    return true;
+                case CfgType::Bool:
+                    return va.b == vb.b;
+                case CfgType::Int:
+                    return va.i == vb.i;
+                case CfgType::UInt:
+                    return va.u == vb.u;
+                case CfgType::Double:
+                    return va.d == vb.d;
+                case CfgType::String:
+                    return a.str(va) == b.str(vb);
+                default:
+                    // containers only show up as leaves when empty
+                    return va.range.count == vb.range.count;
+            }
+        }
+
+        bool is_leaf(const CfgValue& v) {
+            return (v.type != CfgType::Array && v.type != CfgType::Object) || v.range.count == 0;
+        }
+
+        bool covers(std::string_view prefix, std::string_view key) {
+            return key.starts_with(prefix) && (key.size() == prefix.size() || key[prefix.size()] == '/');
+        }
+
+        void append_under(const std::vector<std::string>& keys, std::string_view prefix, std::vector<std::string>& out) {
+            for(const std::string& key : keys) {
+                if(covers(prefix, key)) {
+                    out.push_back(key);
+                }
+            }
+        }
+    }
+
+    CfgDiff CfgDiff::under(std::string_view prefix) const {
+        std::string normalized;
+        if(!prefix.empty()) {
+            normalized = prefix.starts_with('/') ? std::string {prefix} : '/' + std::string {prefix};
+            if(normalized.ends_with('/')) {
+                normalized.pop_back();
+            }
+        }
+        CfgDiff rez {from_version, to_version, {}, {}, {}};
+        append_under(added, normalized, rez.added);
+        append_under(removed, normalized, rez.removed);
+        append_under(changed, normalized, rez.changed);
+        return rez;
+    }
+
+    CfgDiff cfg_diff(const CfgIndex& before, const CfgIndex& after) {
+        CfgDiff rez;
+        for(const CfgEntry& e : before.subtree("")) {
+            const CfgValue* now = after.find(e.key);
+            if(now == nullptr || !is_leaf(*now)) {
+                rez.removed.emplace_back(e.key);
+            }
+        }
+        for(const CfgEntry& e : after.subtree("")) {
+            const CfgValue* was = before.find(e.key);
+            if(was == nullptr || !is_leaf(*was)) {
+                rez.added.emplace_back(e.key);
+            } else if(!same_leaf(before, *was, after, e.value)) {
+                rez.changed.emplace_back(e.key);
+            }
+        }
+        return rez;
+    }
+
+}
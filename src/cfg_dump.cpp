@@ -0,0 +1,273 @@
+#include "cpptanu_cfg/cfg_index.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <system_error>
+#include <unistd.h>
+
+namespace tanu::cfg {
+
+    namespace {
+        bool is_container(const CfgValue& v) {
+            return v.type == CfgType::Array || v.type == CfgType::Object;
+        }
+    }
+
+    // writes json text into a buffer of about chunk_size bytes that goes to
+    // the sink whenever it fills up. strings are escaped the way
+    // json::dump() escapes them.
+    class CfgIndex::Dumper {
+    public:
+        Dumper(const CfgIndex& index, const CfgSink& sink, const CfgDumpOptions& options)
+            : m_index(index), m_sink(sink), m_options(options), m_first(true) {
+            m_buf.reserve(std::max<size_t>(options.chunk_size, 1) + 64);
+        }
+
+        void value(uint32_t idx, int depth) {
+            const CfgValue& v = m_index.m_values[idx];
+            if(!is_container(v)) {
+                scalar(v);
+                return;
+            }
+            const bool object = v.type == CfgType::Object;
+            if(v.range.count == 0 || depth == m_options.max_depth) {
+                put(object ? "{}" : "[]");
+                return;
+            }
+            put(object ? '{' : '[');
+            char buf[16];
+            for(uint32_t c = v.range.begin; c < v.range.begin + v.range.count; c++) {
+                if(c != v.range.begin) {
+                    put(',');
+                }
+                newline(depth + 1);
+                if(object) {
+                    member_name(m_index.segment(c, buf));
+                }
+                value(c, depth + 1);
+            }
+            newline(depth);
+            put(object ? '}' : ']');
+        }
+
+        // the entries of a flattened dump, without the enclosing braces
+        void flattened(uint32_t idx, int depth, std::string& path) {
+            const CfgValue& v = m_index.m_values[idx];
+            if(is_container(v) && v.range.count > 0) {
+                if(depth == m_options.max_depth) {
+                    return;
+                }
+                const size_t path_len = path.size();
+                char buf[16];
+                for(uint32_t c = v.range.begin; c < v.range.begin + v.range.count; c++) {
+                    path.push_back('/');
+                    path.append(m_index.segment(c, buf));
+                    flattened(c, depth + 1, path);
+                    path.resize(path_len);
+                }
+                return;
+            }
+            if(!m_first) {
+                put(',');
+            }
+            m_first = false;
+            newline(1);
+            quoted(path);
+            put(m_options.indent < 0 ? ":" : ": ");
+            if(is_container(v)) {
+                put("null");
+            } else {
+                scalar(v);
+            }
+        }
+
+        void open_flattened() {
+            put('{');
+        }
+
+        void close_flattened() {
+            if(!m_first) {
+                newline(0);
+            }
+            put('}');
+        }
+
+        void finish() {
+            if(!m_buf.empty()) {
+                m_sink(m_buf);
+                m_buf.clear();
+            }
+        }
+
+    private:
+        const CfgIndex& m_index;
+        const CfgSink& m_sink;
+        const CfgDumpOptions& m_options;
+        std::string m_buf;
+        bool m_first;
+
+        void flush_if_full() {
+            if(m_buf.size() >= m_options.chunk_size) {
+                finish();
+            }
+        }
+
+        void put(char c) {
+            m_buf.push_back(c);
+            flush_if_full();
+        }
+
+        void put(std::string_view s) {
+            m_buf.append(s);
+            flush_if_full();
+        }
+
+        void newline(int level) {
+            if(m_options.indent < 0) {
+                return;
+            }
+            m_buf.push_back('\n');
+            m_buf.append(static_cast<size_t>(level) * m_options.indent, ' ');
+            flush_if_full();
+        }
+
+        void escaped(char c) {
+            switch(c) {
+                case '"':
+                    m_buf.append("\\\"");
+                    break;
+                case '\\':
+                    m_buf.append("\\\\");
+                    break;
+                case '\b':
+                    m_buf.append("\\b");
+                    break;
+                case '\f':
+                    m_buf.append("\\f");
+                    break;
+                case '\n':
+                    m_buf.append("\\n");
+                    break;
+                case '\r':
+                    m_buf.append("\\r");
+                    break;
+                case '\t':
+                    m_buf.append("\\t");
+                    break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20) {
+                        constexpr char HEX[] = "0123456789abcdef";
+                        m_buf.append("\\u00");
+                        m_buf.push_back(HEX[(c >> 4) & 0xf]);
+                        m_buf.push_back(HEX[c & 0xf]);
+                    } else {
+                        m_buf.push_back(c);
+                    }
+            }
+        }
+
+        void quoted(std::string_view s) {
+            m_buf.push_back('"');
+            for(const char c : s) {
+                escaped(c);
+            }
+            m_buf.push_back('"');
+            flush_if_full();
+        }
+
+        // a member name from its json pointer segment ("a~1b" is "a/b")
+        void member_name(std::string_view segment) {
+            m_buf.push_back('"');
+            for(size_t i = 0; i < segment.size(); i++) {
+                if(segment[i] == '~' && i + 1 < segment.size()) {
+                    m_buf.push_back(segment[++i] == '1' ? '/' : '~');
+                } else {
+                    escaped(segment[i]);
+                }
+            }
+            m_buf.append(m_options.indent < 0 ? "\":" : "\": ");
+            flush_if_full();
+        }
+
+        void scalar(const CfgValue& v) {
+            char buf[32];
+            switch(v.type) {
+                case CfgType::Bool:
+                    put(v.b ? "true" : "false");
+                    break;
+                case CfgType::Int:
+                    put(std::string_view(buf, std::to_chars(buf, buf + sizeof(buf), v.i).ptr));
+                    break;
+                case CfgType::UInt:
+                    put(std::string_view(buf, std::to_chars(buf, buf + sizeof(buf), v.u).ptr));
+                    break;
+                case CfgType::Double: {
+                    if(!std::isfinite(v.d)) {
+                        put("null");
+                        break;
+                    }
+                    const std::string_view d(buf, std::to_chars(buf, buf + sizeof(buf), v.d).ptr);
+                    put(d);
+                    // keep it a double when read back
+                    if(d.find_first_of(".e") == std::string_view::npos) {
+                        put(".0");
+                    }
+                    break;
+                }
+                case CfgType::String:
+                    quoted(m_index.str(v));
+                    break;
+                default:
+                    put("null");
+            }
+        }
+    };
+
+    bool CfgIndex::dump(const CfgSink& sink, const CfgDumpOptions& options) const {
+        std::string_view key = options.prefix;
+        while(key.ends_with('/')) {
+            key.remove_suffix(1);
+        }
+        const CfgValue* v = key.empty() ? &root() : find(key);
+        if(v == nullptr) {
+            return false;
+        }
+        Dumper dumper(*this, sink, options);
+        if(options.flattened) {
+            std::string path;
+            if(!key.empty()) {
+                path = key.starts_with('/') ? std::string {key} : '/' + std::string {key};
+            }
+            dumper.open_flattened();
+            dumper.flattened(position(*v), 0, path);
+            dumper.close_flattened();
+        } else {
+            dumper.value(position(*v), 0);
+        }
+        dumper.finish();
+        return true;
+    }
+
+    CfgSink cfg_ostream_sink(std::ostream& out) {
+        return [&out](std::string_view chunk) {
+            out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        };
+    }
+
+    CfgSink cfg_fd_sink(int fd) {
+        return [fd](std::string_view chunk) {
+            while(!chunk.empty()) {
+                const ssize_t n = ::write(fd, chunk.data(), chunk.size());
+                if(n < 0) {
+                    if(errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "writing a config dump");
+                }
+                chunk.remove_prefix(static_cast<size_t>(n));
+            }
+        };
+    }
+
+}
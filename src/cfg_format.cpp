@@ -0,0 +1,181 @@
+#include "cpptanu_cfg/cfg_format.h"
+#include "cpptanu_cfg/cfg_index.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace tanu::cfg {
+
+    namespace {
+        // nlohmann's SAX events for the binary formats, handed to the
+        // Builder as they come
+        class BuilderSax {
+        public:
+            explicit BuilderSax(CfgIndex::Builder& builder): m_builder(builder) {}
+
+            bool null() {
+                m_builder.null_value();
+                return true;
+            }
+            bool boolean(bool b) {
+                m_builder.bool_value(b);
+                return true;
+            }
+            bool number_integer(json::number_integer_t i) {
+                m_builder.int_value(i);
+                return true;
+            }
+            bool number_unsigned(json::number_unsigned_t u) {
+                m_builder.uint_value(u);
+                return true;
+            }
+            bool number_float(json::number_float_t d, const json::string_t&) {
+                m_builder.double_value(d);
+                return true;
+            }
+            bool string(json::string_t& s) {
+                m_builder.string_value(s);
+                return true;
+            }
+            bool binary(json::binary_t&) {
+                throw std::runtime_error("binary values are not supported in configs");
+            }
+            bool start_object(std::size_t) {
+                m_builder.begin_object();
+                return true;
+            }
+            bool key(json::string_t& name) {
+                m_builder.key(name);
+                return true;
+            }
+            bool end_object() {
+                m_builder.end_container();
+                return true;
+            }
+            bool start_array(std::size_t) {
+                m_builder.begin_array();
+                return true;
+            }
+            bool end_array() {
+                m_builder.end_container();
+                return true;
+            }
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) {
+                throw std::runtime_error(e.what());
+            }
+
+        private:
+            CfgIndex::Builder& m_builder;
+        };
+
+        json::input_format_t input_format(CfgFormat format) {
+            switch(format) {
+                case CfgFormat::Cbor:
+                    return json::input_format_t::cbor;
+                case CfgFormat::MsgPack:
+                    return json::input_format_t::msgpack;
+                case CfgFormat::Bson:
+                    return json::input_format_t::bson;
+                default:
+                    return json::input_format_t::json;
+            }
+        }
+
+        // the cbor self-describe tag, d9 d9 f7
+        bool has_cbor_magic(std::string_view bytes) noexcept {
+            return bytes.starts_with("\xd9\xd9\xf7");
+        }
+    }
+
+    const char* cfg_format_name(CfgFormat format) noexcept {
+        switch(format) {
+            case CfgFormat::Cbor:
+                return "cbor";
+            case CfgFormat::MsgPack:
+                return "msgpack";
+            case CfgFormat::Bson:
+                return "bson";
+            default:
+                return "json";
+        }
+    }
+
+    std::optional<CfgFormat> cfg_format_from_name(std::string_view name) noexcept {
+        for(const CfgFormat format : {CfgFormat::Json, CfgFormat::Cbor, CfgFormat::MsgPack, CfgFormat::Bson}) {
+            if(name == cfg_format_name(format)) {
+                return format;
+            }
+        }
+        return std::nullopt;
+    }
+
+    CfgFormat cfg_detect_format(const std::filesystem::path& fpath, std::string_view bytes) noexcept {
+        const std::string ext = fpath.extension().string();
+        if(ext == ".json") {
+            return CfgFormat::Json;
+        } else if(ext == ".cbor") {
+            return CfgFormat::Cbor;
+        } else if(ext == ".msgpack" || ext == ".mpk") {
+            return CfgFormat::MsgPack;
+        } else if(ext == ".bson") {
+            return CfgFormat::Bson;
+        }
+        if(bytes.empty()) {
+            return CfgFormat::Json;
+        }
+        // a bson document opens with its own total length, little endian,
+        // and closes with a nul
+        if(bytes.size() >= 5 && bytes.back() == '\0') {
+            uint32_t len = 0;
+            for(int i = 3; i >= 0; i--) {
+                len = (len << 8) | static_cast<uint8_t>(bytes[i]);
+            }
+            if(len == bytes.size()) {
+                return CfgFormat::Bson;
+            }
+        }
+        // text json never starts with a byte above 0x7f (save a utf-8 bom).
+        // objects are maps 0xa0-0xbb/0xbf in cbor, 0x80-0x8f/0xde/0xdf in
+        // msgpack.
+        const uint8_t lead = static_cast<uint8_t>(bytes[0]);
+        if(has_cbor_magic(bytes) || (lead >= 0xa0 && lead <= 0xbb) || lead == 0xbf) {
+            return CfgFormat::Cbor;
+        }
+        if((lead >= 0x80 && lead <= 0x8f) || lead == 0xde || lead == 0xdf) {
+            return CfgFormat::MsgPack;
+        }
+        return CfgFormat::Json;
+    }
+
+    std::vector<uint8_t> cfg_encode(const json& doc, CfgFormat format) {
+        switch(format) {
+            case CfgFormat::Cbor:
+                return json::to_cbor(doc);
+            case CfgFormat::MsgPack:
+                return json::to_msgpack(doc);
+            case CfgFormat::Bson:
+                return json::to_bson(doc);
+            default: {
+                const std::string text = doc.dump();
+                return std::vector<uint8_t>(text.begin(), text.end());
+            }
+        }
+    }
+
+    CfgIndex CfgIndex::parse(std::string_view bytes, CfgFormat format) {
+        if(format == CfgFormat::Json) {
+            return parse(bytes);
+        }
+        if(format == CfgFormat::Cbor && has_cbor_magic(bytes)) {
+            // nlohmann rejects tags by default; this one only marks the format
+            bytes.remove_prefix(3);
+        }
+        Builder builder;
+        BuilderSax sax(builder);
+        if(!json::sax_parse(bytes.begin(), bytes.end(), &sax, input_format(format))) {
+            throw std::runtime_error(std::string("malformed ") + cfg_format_name(format));
+        }
+        return builder.finish();
+    }
+
+}
@@ -0,0 +1,188 @@
+#include "cpptanu_cfg/cfg_index.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+namespace tanu::cfg {
+
+    namespace {
+        constexpr char IMAGE_MAGIC[8] = {'T', 'A', 'N', 'U', 'C', 'F', 'G', '\0'};
+        constexpr uint32_t IMAGE_FORMAT = 1;
+        constexpr uint64_t IMAGE_BYTE_ORDER = 0x0102030405060708ull;
+    }
+
+    struct CfgIndex::ImageHeader {
+        char magic[8];
+        uint32_t format;
+        // rejects images written by a build with another value layout
+        uint32_t value_size;
+        uint64_t byte_order;
+        uint64_t source_size;
+        int64_t source_mtime;
+        uint64_t source_hash;
+        // the source path follows the header, the arena starts at arena_off
+        uint64_t path_len;
+        uint64_t arena_off;
+        Layout layout;
+    };
+
+    std::filesystem::path cfg_image_path(const std::filesystem::path& source) {
+        std::filesystem::path image = source;
+        image += ".tcfg";
+        return image;
+    }
+
+    uint64_t cfg_content_hash(std::string_view bytes) noexcept {
+        uint64_t h = CFG_KEY_HASH_BASIS ^ bytes.size();
+        size_t i = 0;
+        for(; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes.data() + i, sizeof(word));
+            h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 32;
+        }
+        for(; i < bytes.size(); i++) {
+            h = cfg_key_hash_step(h, bytes[i]);
+        }
+        return h;
+    }
+
+    CfgIndex::ImageHeader CfgIndex::image_header(const CfgImageKey& key) const noexcept {
+        ImageHeader header {};
+        std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        header.format = IMAGE_FORMAT;
+        header.value_size = sizeof(CfgValue);
+        header.byte_order = IMAGE_BYTE_ORDER;
+        header.source_size = key.size;
+        header.source_mtime = key.mtime;
+        header.source_hash = key.hash;
+        header.path_len = key.source.size();
+        // mappings are page aligned, so a cache line aligned arena keeps every
+        // section on the alignment it was built with
+        header.arena_off = (sizeof(header) + key.source.size() + 63) & ~uint64_t {63};
+        header.layout = m_layout;
+        return header;
+    }
+
+    size_t CfgIndex::image_size(const CfgImageKey& key) const noexcept {
+        return image_header(key).arena_off + m_layout.size;
+    }
+
+    void CfgIndex::write_image(std::byte* dst, const CfgImageKey& key) const noexcept {
+        const ImageHeader header = image_header(key);
+        std::memcpy(dst, &header, sizeof(header));
+        std::memcpy(dst + sizeof(header), key.source.data(), key.source.size());
+        std::memset(dst + sizeof(header) + key.source.size(), 0, header.arena_off - sizeof(header) - key.source.size());
+        std::memcpy(dst + header.arena_off, m_base, m_layout.size);
+    }
+
+    void CfgIndex::write_image(const std::filesystem::path& image_path, const CfgImageKey& key) const {
+        const ImageHeader header = image_header(key);
+
+        // written aside and renamed into place, so concurrent loaders only
+        // ever map a complete image
+        std::filesystem::path tmp = image_path;
+        tmp += std::format(".{:x}.tmp", std::random_device {}());
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            const std::string padding(header.arena_off - sizeof(header) - key.source.size(), '\0');
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(key.source.data(), key.source.size());
+            out.write(padding.data(), padding.size());
+            out.write(reinterpret_cast<const char*>(m_base), m_layout.size);
+            out.flush();
+            if(!out) {
+                std::error_code ec;
+                std::filesystem::remove(tmp, ec);
+                throw std::runtime_error(std::format("writing {} failed", tmp.string()));
+            }
+        }
+        // whatever the umask, nobody else may write an image loaders trust
+        std::error_code ec;
+        std::filesystem::permissions(tmp, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write
+            | std::filesystem::perms::group_read | std::filesystem::perms::others_read, ec);
+        std::filesystem::rename(tmp, image_path, ec);
+        if(ec) {
+            std::filesystem::remove(tmp, ec);
+            throw std::runtime_error(std::format("replacing {} failed", image_path.string()));
+        }
+    }
+
+    std::optional<CfgIndex> CfgIndex::open_image(
+        const std::filesystem::path& image_path,
+        const std::function<bool(const CfgImageKey&)>& accept) {
+
+        std::shared_ptr<const MappedFile> file;
+        try {
+            file = std::make_shared<const MappedFile>(image_path, false);
+        } catch(const std::runtime_error&) {
+            return std::nullopt;
+        }
+        return open_image(std::move(file), accept);
+    }
+
+    std::optional<CfgIndex> CfgIndex::open_image(
+        std::shared_ptr<const MappedFile> file,
+        const std::function<bool(const CfgImageKey&)>& accept) {
+
+        const std::string_view bytes = file->bytes();
+        ImageHeader header;
+        if(bytes.size() < sizeof(header)) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if(std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || header.format != IMAGE_FORMAT
+                || header.value_size != sizeof(CfgValue) || header.byte_order != IMAGE_BYTE_ORDER) {
+            return std::nullopt;
+        }
+        if(header.path_len > bytes.size() - sizeof(header) || header.arena_off % 64 != 0
+                || header.arena_off < sizeof(header) + header.path_len || header.arena_off > bytes.size()
+                || header.layout.size != bytes.size() - header.arena_off) {
+            return std::nullopt;
+        }
+
+        // only this user's own images are used at all, so beyond the header
+        // and section bounds nothing is checked: opening one costs a few page
+        // faults whatever its size. the bounds catch truncated or foreign
+        // files; a string view that would leave its section comes back
+        // empty (see str_array()).
+        if(!file->owned()) {
+            return std::nullopt;
+        }
+        const Layout& l = header.layout;
+        auto fits = [&l](uint64_t off, uint64_t count, size_t elem) {
+            return off % 64 == 0 && off <= l.size && count <= (l.size - off) / elem;
+        };
+        if(l.value_count == 0 || l.root >= l.value_count || !std::has_single_bit(l.slot_count)
+                || l.slot_count <= l.value_count
+                || !fits(l.values_off, l.value_count, sizeof(CfgValue)) || !fits(l.nodes_off, l.value_count, sizeof(Node))
+                || !fits(l.slots_off, l.slot_count, sizeof(Slot)) || !fits(l.segs_off, l.seg_count, sizeof(KeyRef))
+                || !fits(l.str_refs_off, l.str_ref_count, sizeof(KeyRef)) || !fits(l.ints_off, l.int_count, sizeof(int64_t))
+                || !fits(l.doubles_off, l.double_count, sizeof(double)) || !fits(l.seg_chars_off, l.seg_chars_len, 1)
+                || !fits(l.str_chars_off, l.str_chars_len, 1)) {
+            return std::nullopt;
+        }
+        const std::byte* base = reinterpret_cast<const std::byte*>(bytes.data() + header.arena_off);
+
+        const CfgImageKey key {
+            std::string {bytes.substr(sizeof(header), header.path_len)},
+            header.source_size,
+            header.source_mtime,
+            header.source_hash
+        };
+        if(!accept(key)) {
+            return std::nullopt;
+        }
+        CfgIndex index;
+        index.m_image = std::move(file);
+        index.attach(base, l);
+        return index;
+    }
+
+}
@@ -0,0 +1,644 @@
+#include "cpptanu_cfg/cfg_index.h"
+
+#include <bit>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace tanu::cfg {
+
+    namespace {
+        uint64_t string_hash(std::string_view s) noexcept {
+            uint64_t h = CFG_KEY_HASH_BASIS;
+            for(const char c : s) {
+                h = cfg_key_hash_step(h, c);
+            }
+            return h;
+        }
+
+        // json pointer escaping, same as json::flatten()
+        void escape_segment(std::string& segment, std::string_view name) {
+            segment.clear();
+            for(const char c : name) {
+                if(c == '~') {
+                    segment.append("~0");
+                } else if(c == '/') {
+                    segment.append("~1");
+                } else {
+                    segment.push_back(c);
+                }
+            }
+        }
+
+        template<typename T>
+        std::span<const T> section(const std::byte* base, uint64_t off, uint64_t count) {
+            return std::span<const T>(reinterpret_cast<const T*>(base + off), count);
+        }
+
+        std::string unescape_segment(std::string_view segment) {
+            std::string name;
+            name.reserve(segment.size());
+            for(size_t i = 0; i < segment.size(); i++) {
+                if(segment[i] == '~' && i + 1 < segment.size()) {
+                    name.push_back(segment[i + 1] == '1' ? '/' : '~');
+                    i++;
+                } else {
+                    name.push_back(segment[i]);
+                }
+            }
+            return name;
+        }
+
+        void build_from_json(const json& j, CfgIndex::Builder& b) {
+            switch(j.type()) {
+                case json::value_t::boolean:
+                    b.bool_value(j.get<bool>());
+                    break;
+                case json::value_t::number_integer:
+                    b.int_value(j.get<int64_t>());
+                    break;
+                case json::value_t::number_unsigned:
+                    b.uint_value(j.get<uint64_t>());
+                    break;
+                case json::value_t::number_float:
+                    b.double_value(j.get<double>());
+                    break;
+                case json::value_t::string:
+                    b.string_value(j.get_ref<const std::string&>());
+                    break;
+                case json::value_t::array:
+                    b.begin_array();
+                    for(const auto& e : j) {
+                        build_from_json(e, b);
+                    }
+                    b.end_container();
+                    break;
+                case json::value_t::object:
+                    b.begin_object();
+                    for(const auto& [name, e] : j.items()) {
+                        b.key(name);
+                        build_from_json(e, b);
+                    }
+                    b.end_container();
+                    break;
+                default:
+                    b.null_value();
+                    break;
+            }
+        }
+    }
+
+    CfgIndex::CfgIndex(const json& root) {
+        Builder b;
+        build_from_json(root, b);
+        *this = b.finish();
+    }
+
+    CfgIndex::Builder::Builder(): m_key(npos), m_root(0), m_has_root(false), m_dropped(false) {
+    }
+
+    std::string cfg_pointer_segment(std::string_view name) {
+        std::string segment;
+        escape_segment(segment, name);
+        return segment;
+    }
+
+    uint32_t CfgIndex::Builder::Interner::intern(std::string_view s) {
+        if(refs.size() * 2 >= m_slots.size()) {
+            m_slots.assign(std::max<size_t>(64, m_slots.size() * 2), npos);
+            const uint64_t mask = m_slots.size() - 1;
+            for(uint32_t id = 0; id < refs.size(); id++) {
+                uint64_t pos = string_hash(at(id)) & mask;
+                while(m_slots[pos] != npos) {
+                    pos = (pos + 1) & mask;
+                }
+                m_slots[pos] = id;
+            }
+        }
+        const uint64_t mask = m_slots.size() - 1;
+        for(uint64_t pos = string_hash(s) & mask; ; pos = (pos + 1) & mask) {
+            const uint32_t id = m_slots[pos];
+            if(id == npos) {
+                m_slots[pos] = static_cast<uint32_t>(refs.size());
+                refs.push_back(KeyRef{static_cast<uint32_t>(chars.size()), static_cast<uint32_t>(s.size())});
+                chars.insert(chars.end(), s.begin(), s.end());
+                return m_slots[pos];
+            }
+            if(at(id) == s) {
+                return id;
+            }
+        }
+    }
+
+    uint32_t CfgIndex::Builder::next_seg() {
+        if(m_frames.empty() || m_frames.back().type == CfgType::Array) {
+            // the root and array elements are named by their position
+            return npos;
+        }
+        if(m_key == npos) {
+            throw std::runtime_error("object member without a key");
+        }
+        const uint32_t seg = m_key;
+        m_key = npos;
+        return seg;
+    }
+
+    void CfgIndex::Builder::add(const CfgValue& v, uint32_t seg) {
+        if(!m_frames.empty()) {
+            m_pending.push_back(Pending{v, seg});
+            return;
+        }
+        if(m_has_root) {
+            throw std::runtime_error("more than one root value");
+        }
+        m_root = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(v);
+        m_value_segs.push_back(seg);
+        m_has_root = true;
+    }
+
+    void CfgIndex::Builder::begin_container(CfgType type) {
+        const uint32_t self_seg = next_seg();
+        m_frames.push_back(Frame{type, self_seg, m_pending.size()});
+    }
+
+    void CfgIndex::Builder::begin_object() {
+        begin_container(CfgType::Object);
+    }
+
+    void CfgIndex::Builder::begin_array() {
+        begin_container(CfgType::Array);
+    }
+
+    void CfgIndex::Builder::key(std::string_view name) {
+        if(m_frames.empty() || m_frames.back().type != CfgType::Object) {
+            throw std::runtime_error("key outside of an object");
+        }
+        escape_segment(m_scratch, name);
+        m_key = m_names.intern(m_scratch);
+    }
+
+    void CfgIndex::Builder::escaped_key(std::string_view segment) {
+        if(m_frames.empty() || m_frames.back().type != CfgType::Object) {
+            throw std::runtime_error("key outside of an object");
+        }
+        m_key = m_names.intern(segment);
+    }
+
+    void CfgIndex::Builder::end_container() {
+        if(m_frames.empty()) {
+            throw std::runtime_error("unbalanced container end");
+        }
+        const Frame f = m_frames.back();
+        m_frames.pop_back();
+
+        // a container's children go into the value table as one block, after
+        // everything their own subtrees already put there
+        CfgValue c {};
+        c.type = f.type;
+        c.pool = npos;
+        c.range.begin = static_cast<uint32_t>(m_values.size());
+        if(f.type == CfgType::Object) {
+            // a repeated member name keeps only its last value, as
+            // json::parse does; finish() drops what hangs below the others
+            for(size_t i = f.pending_begin; i < m_pending.size(); i++) {
+                const uint32_t seg = m_pending[i].seg;
+                if(seg >= m_last_member.size()) {
+                    m_last_member.resize(m_names.refs.size());
+                }
+                m_last_member[seg] = i;
+            }
+        }
+        for(size_t i = f.pending_begin; i < m_pending.size(); i++) {
+            if(f.type == CfgType::Object && m_last_member[m_pending[i].seg] != i) {
+                m_dropped = true;
+                continue;
+            }
+            m_values.push_back(m_pending[i].value);
+            m_value_segs.push_back(m_pending[i].seg);
+        }
+        c.range.count = static_cast<uint32_t>(m_values.size() - c.range.begin);
+        m_pending.resize(f.pending_begin);
+        m_key = npos;
+        add(c, f.self_seg);
+    }
+
+    void CfgIndex::Builder::null_value() {
+        CfgValue v {};
+        v.type = CfgType::Null;
+        v.pool = npos;
+        add(v, next_seg());
+    }
+
+    void CfgIndex::Builder::bool_value(bool b) {
+        CfgValue v {};
+        v.type = CfgType::Bool;
+        v.pool = npos;
+        v.b = b;
+        add(v, next_seg());
+    }
+
+    void CfgIndex::Builder::int_value(int64_t i) {
+        CfgValue v {};
+        v.type = CfgType::Int;
+        v.pool = npos;
+        v.i = i;
+        add(v, next_seg());
+    }
+
+    void CfgIndex::Builder::uint_value(uint64_t u) {
+        CfgValue v {};
+        v.pool = npos;
+        if(u <= static_cast<uint64_t>(INT64_MAX)) {
+            v.type = CfgType::Int;
+            v.i = static_cast<int64_t>(u);
+        } else {
+            v.type = CfgType::UInt;
+            v.u = u;
+        }
+        add(v, next_seg());
+    }
+
+    void CfgIndex::Builder::double_value(double d) {
+        CfgValue v {};
+        v.type = CfgType::Double;
+        v.pool = npos;
+        v.d = d;
+        add(v, next_seg());
+    }
+
+    void CfgIndex::Builder::string_value(std::string_view s) {
+        CfgValue v {};
+        v.type = CfgType::String;
+        v.pool = npos;
+        const uint32_t id = m_strings.intern(s);
+        v.str.off = m_strings.refs[id].off;
+        v.str.len = m_strings.refs[id].len;
+        add(v, next_seg());
+    }
+
+    void CfgIndex::Builder::drop_unreachable() {
+        // parents sit after their children, so walking backwards from the
+        // root reaches every live value before its children are looked at
+        const size_t n = m_values.size();
+        std::vector<bool> live(n, false);
+        live[m_root] = true;
+        for(size_t idx = n; idx-- > 0; ) {
+            const CfgValue& v = m_values[idx];
+            if(live[idx] && (v.type == CfgType::Array || v.type == CfgType::Object)) {
+                std::fill_n(live.begin() + v.range.begin, v.range.count, true);
+            }
+        }
+        // live values keep their order, so every child block stays one block
+        std::vector<uint32_t> moved(n);
+        uint32_t next = 0;
+        for(size_t idx = 0; idx < n; idx++) {
+            moved[idx] = next;
+            if(!live[idx]) {
+                continue;
+            }
+            CfgValue v = m_values[idx];
+            if(v.type == CfgType::Array || v.type == CfgType::Object) {
+                v.range.begin = moved[v.range.begin];
+            }
+            m_values[next] = v;
+            m_value_segs[next] = m_value_segs[idx];
+            next++;
+        }
+        m_root = moved[m_root];
+        m_values.resize(next);
+        m_value_segs.resize(next);
+    }
+
+    CfgIndex CfgIndex::Builder::finish() {
+        if(!m_frames.empty() || !m_has_root) {
+            throw std::runtime_error("incomplete document");
+        }
+        m_pending.clear();
+        m_pending.shrink_to_fit();
+        if(m_dropped) {
+            drop_unreachable();
+        }
+
+        const size_t n = m_values.size();
+        std::vector<Node> nodes(n, Node{npos, npos});
+        for(uint32_t p = 0; p < n; p++) {
+            const CfgValue& c = m_values[p];
+            if(c.type != CfgType::Array && c.type != CfgType::Object) {
+                continue;
+            }
+            for(uint32_t i = c.range.begin; i < c.range.begin + c.range.count; i++) {
+                nodes[i] = Node{p, m_value_segs[i]};
+            }
+        }
+        m_value_segs.clear();
+        m_value_segs.shrink_to_fit();
+
+        // homogeneous arrays also get a typed copy. arrays of at least a
+        // cache line's worth of numbers start on a fresh cache line.
+        constexpr size_t line_elems = 64 / sizeof(int64_t);
+        auto aligned_size = [](size_t size, size_t count) {
+            return count >= line_elems ? (size + line_elems - 1) / line_elems * line_elems : size;
+        };
+        std::vector<int64_t> int_pool;
+        std::vector<double> double_pool;
+        std::vector<KeyRef> str_refs;
+        for(CfgValue& arr : m_values) {
+            if(arr.type != CfgType::Array || arr.range.count == 0) {
+                continue;
+            }
+            const CfgType elem_type = m_values[arr.range.begin].type;
+            if(elem_type != CfgType::Int && elem_type != CfgType::Double && elem_type != CfgType::String) {
+                continue;
+            }
+            bool homogeneous = true;
+            for(uint32_t i = 0; i < arr.range.count && homogeneous; i++) {
+                homogeneous = m_values[arr.range.begin + i].type == elem_type;
+            }
+            if(!homogeneous) {
+                continue;
+            }
+            if(elem_type == CfgType::Int) {
+                int_pool.resize(aligned_size(int_pool.size(), arr.range.count));
+                arr.pool = static_cast<uint32_t>(int_pool.size());
+                for(uint32_t i = 0; i < arr.range.count; i++) {
+                    int_pool.push_back(m_values[arr.range.begin + i].i);
+                }
+            } else if(elem_type == CfgType::Double) {
+                double_pool.resize(aligned_size(double_pool.size(), arr.range.count));
+                arr.pool = static_cast<uint32_t>(double_pool.size());
+                for(uint32_t i = 0; i < arr.range.count; i++) {
+                    double_pool.push_back(m_values[arr.range.begin + i].d);
+                }
+            } else {
+                arr.pool = static_cast<uint32_t>(str_refs.size());
+                for(uint32_t i = 0; i < arr.range.count; i++) {
+                    const CfgValue& e = m_values[arr.range.begin + i];
+                    str_refs.push_back(KeyRef{e.str.off, e.str.len});
+                }
+            }
+        }
+
+        // one allocation for the whole index, each section on its own
+        // cache line
+        Layout layout {};
+        auto reserve = [&layout](size_t bytes) {
+            const uint64_t off = (layout.size + 63) & ~uint64_t {63};
+            layout.size = off + bytes;
+            return off;
+        };
+        layout.root = m_root;
+        layout.value_count = n;
+        layout.slot_count = std::bit_ceil(std::max<size_t>(8, n * 2));
+        layout.seg_count = m_names.refs.size();
+        layout.str_ref_count = str_refs.size();
+        layout.int_count = int_pool.size();
+        layout.double_count = double_pool.size();
+        layout.seg_chars_len = m_names.chars.size();
+        layout.str_chars_len = m_strings.chars.size();
+        layout.values_off = reserve(n * sizeof(CfgValue));
+        layout.nodes_off = reserve(n * sizeof(Node));
+        layout.slots_off = reserve(layout.slot_count * sizeof(Slot));
+        layout.segs_off = reserve(layout.seg_count * sizeof(KeyRef));
+        layout.str_refs_off = reserve(layout.str_ref_count * sizeof(KeyRef));
+        layout.ints_off = reserve(layout.int_count * sizeof(int64_t));
+        layout.doubles_off = reserve(layout.double_count * sizeof(double));
+        layout.seg_chars_off = reserve(layout.seg_chars_len);
+        layout.str_chars_off = reserve(layout.str_chars_len);
+
+        CfgIndex index;
+        index.m_arena.resize(layout.size);
+        std::byte* const base = index.m_arena.data();
+        auto place = [base](uint64_t off, const auto& src) {
+            using T = typename std::decay_t<decltype(src)>::value_type;
+            if(!src.empty()) {
+                std::memcpy(base + off, src.data(), src.size() * sizeof(T));
+            }
+        };
+        place(layout.values_off, m_values);
+        place(layout.nodes_off, nodes);
+        place(layout.segs_off, m_names.refs);
+        place(layout.str_refs_off, str_refs);
+        place(layout.ints_off, int_pool);
+        place(layout.doubles_off, double_pool);
+        place(layout.seg_chars_off, m_names.chars);
+        place(layout.str_chars_off, m_strings.chars);
+
+        m_values.clear();
+        m_values.shrink_to_fit();
+        nodes.clear();
+        nodes.shrink_to_fit();
+        m_names = Interner {};
+        m_strings = Interner {};
+
+        const std::span<Slot> slots(reinterpret_cast<Slot*>(base + layout.slots_off), layout.slot_count);
+        std::fill(slots.begin(), slots.end(), Slot{0, npos});
+        index.attach(base, layout);
+        index.build_table(slots);
+        return index;
+    }
+
+    void CfgIndex::attach(const std::byte* base, const Layout& layout) {
+        m_base = base;
+        m_layout = layout;
+        m_values = section<CfgValue>(base, layout.values_off, layout.value_count);
+        m_nodes = section<Node>(base, layout.nodes_off, layout.value_count);
+        m_slots = section<Slot>(base, layout.slots_off, layout.slot_count);
+        m_segs = section<KeyRef>(base, layout.segs_off, layout.seg_count);
+        m_str_refs = section<KeyRef>(base, layout.str_refs_off, layout.str_ref_count);
+        m_int_pool = section<int64_t>(base, layout.ints_off, layout.int_count);
+        m_double_pool = section<double>(base, layout.doubles_off, layout.double_count);
+        m_seg_chars = std::string_view(reinterpret_cast<const char*>(base + layout.seg_chars_off), layout.seg_chars_len);
+        m_str_chars = std::string_view(reinterpret_cast<const char*>(base + layout.str_chars_off), layout.str_chars_len);
+        m_mask = layout.slot_count - 1;
+        m_root = static_cast<uint32_t>(layout.root);
+        m_str_views = std::make_unique<StrViews>();
+    }
+
+    std::string_view CfgIndex::segment(uint32_t idx, char (&buf)[16]) const noexcept {
+        const Node& node = m_nodes[idx];
+        if(node.seg != npos) {
+            return m_seg_chars.substr(m_segs[node.seg].off, m_segs[node.seg].len);
+        }
+        const uint32_t pos = idx - m_values[node.parent].range.begin;
+        const char* end = std::to_chars(buf, buf + sizeof(buf), pos).ptr;
+        return std::string_view(buf, end - buf);
+    }
+
+    void CfgIndex::build_table(std::span<Slot> slots) {
+        // parents always sit after their children, so walking backwards
+        // hashes every parent before its children extend that hash
+        std::vector<uint64_t> hashes(m_values.size());
+        char buf[16];
+        for(size_t idx = m_values.size(); idx-- > 0; ) {
+            if(idx == m_root) {
+                hashes[idx] = CFG_KEY_HASH_BASIS;
+                continue;
+            }
+            uint64_t h = cfg_key_hash_step(hashes[m_nodes[idx].parent], '/');
+            for(const char c : segment(static_cast<uint32_t>(idx), buf)) {
+                h = cfg_key_hash_step(h, c);
+            }
+            hashes[idx] = h;
+        }
+
+        for(uint32_t idx = 0; idx < m_values.size(); idx++) {
+            // the root has no key of its own
+            if(idx == m_root) {
+                continue;
+            }
+            const uint64_t h = hashes[idx];
+            // every path is unique: the builder keeps one value per member name
+            uint64_t pos = h & m_mask;
+            while(slots[pos].value != npos) {
+                pos = (pos + 1) & m_mask;
+            }
+            slots[pos] = Slot{static_cast<uint32_t>(h), idx};
+        }
+    }
+
+    std::span<const int64_t> CfgIndex::int_array(const CfgValue& arr) const noexcept {
+        if(arr.type != CfgType::Array || arr.pool == npos || m_values[arr.range.begin].type != CfgType::Int) {
+            return {};
+        }
+        return m_int_pool.subspan(arr.pool, arr.range.count);
+    }
+
+    std::span<const double> CfgIndex::double_array(const CfgValue& arr) const noexcept {
+        if(arr.type != CfgType::Array || arr.pool == npos || m_values[arr.range.begin].type != CfgType::Double) {
+            return {};
+        }
+        return m_double_pool.subspan(arr.pool, arr.range.count);
+    }
+
+    std::span<const std::string_view> CfgIndex::str_array(const CfgValue& arr) const noexcept {
+        if(arr.type != CfgType::Array || arr.pool == npos || m_values[arr.range.begin].type != CfgType::String) {
+            return {};
+        }
+        // views hold addresses, so each mapping makes its own, once something
+        // reads a string array
+        std::call_once(m_str_views->once, [this] {
+            m_str_views->views.reserve(m_str_refs.size());
+            for(const KeyRef& ref : m_str_refs) {
+                m_str_views->views.push_back(ref.off <= m_str_chars.size() ? m_str_chars.substr(ref.off, ref.len) : std::string_view {});
+            }
+        });
+        return std::span<const std::string_view>(m_str_views->views.data() + arr.pool, arr.range.count);
+    }
+
+    CfgMemoryUsage CfgIndex::memory_usage() const noexcept {
+        CfgMemoryUsage usage {};
+        usage.values = m_values.size_bytes() + m_nodes.size_bytes();
+        usage.keys = m_segs.size_bytes() + m_seg_chars.size();
+        usage.strings = m_str_chars.size() + m_str_refs.size_bytes() + m_str_refs.size() * sizeof(std::string_view);
+        usage.table = m_slots.size_bytes();
+        usage.arrays = m_int_pool.size_bytes() + m_double_pool.size_bytes();
+        return usage;
+    }
+
+    json CfgIndex::to_json() const {
+        return to_json(root());
+    }
+
+    json CfgIndex::to_json(const CfgValue& v) const {
+        switch(v.type) {
+            case CfgType::Bool:
+                return v.b;
+            case CfgType::Int:
+                return v.i;
+            case CfgType::UInt:
+                return v.u;
+            case CfgType::Double:
+                return v.d;
+            case CfgType::String:
+                return std::string {str(v)};
+            case CfgType::Array: {
+                json arr = json::array();
+                for(uint32_t i = 0; i < v.range.count; i++) {
+                    arr.push_back(to_json(child(v, i)));
+                }
+                return arr;
+            }
+            case CfgType::Object: {
+                json obj = json::object();
+                char buf[16];
+                for(uint32_t i = 0; i < v.range.count; i++) {
+                    obj[unescape_segment(segment(v.range.begin + i, buf))] = to_json(child(v, i));
+                }
+                return obj;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    json CfgIndex::to_flattened_json() const {
+        // same shape json::flatten() gives: every leaf by its pointer path,
+        // empty containers as null
+        json flat = json::object();
+        std::string path;
+        flatten_into(flat, m_root, path);
+        return flat;
+    }
+
+    void CfgIndex::flatten_into(json& flat, uint32_t idx, std::string& path) const {
+        const CfgValue& v = m_values[idx];
+        const bool container = v.type == CfgType::Array || v.type == CfgType::Object;
+        if(!container || v.range.count == 0) {
+            flat[path] = container ? json(nullptr) : to_json(v);
+            return;
+        }
+        const size_t path_len = path.size();
+        char buf[16];
+        for(uint32_t i = v.range.begin; i < v.range.begin + v.range.count; i++) {
+            path.push_back('/');
+            path.append(segment(i, buf));
+            flatten_into(flat, i, path);
+            path.resize(path_len);
+        }
+    }
+
+    bool CfgIndex::key_equals(uint32_t idx, std::string_view key) const noexcept {
+        // match the key against the stored segments from its end towards the
+        // root. a key without its leading '/' is read as if it had one.
+        const size_t lead = (key.empty() || key.front() != '/') ? 1 : 0;
+        size_t end = key.size() + lead;
+        char buf[16];
+        while(idx != m_root) {
+            const std::string_view seg = segment(idx, buf);
+            if(end < seg.size() + 1) {
+                return false;
+            }
+            const size_t start = end - seg.size();
+            if(key.substr(start - lead, seg.size()) != seg) {
+                return false;
+            }
+            const size_t slash = start - 1;
+            if(slash >= lead && key[slash - lead] != '/') {
+                return false;
+            }
+            end = slash;
+            idx = m_nodes[idx].parent;
+        }
+        return end == 0;
+    }
+
+    const CfgValue* CfgIndex::find(std::string_view key) const noexcept {
+        return find(key, cfg_key_hash(key));
+    }
+
+    const CfgValue* CfgIndex::find(std::string_view key, uint64_t hash) const noexcept {
+        const uint32_t tag = static_cast<uint32_t>(hash);
+        for(uint64_t pos = hash & m_mask; ; pos = (pos + 1) & m_mask) {
+            const Slot& s = m_slots[pos];
+            if(s.value == npos) {
+                return nullptr;
+            }
+            if(s.hash == tag && key_equals(s.value, key)) {
+                return &m_values[s.value];
+            }
+        }
+    }
+
+}
@@ -0,0 +1,135 @@
+#include "cpptanu_cfg/cfg_lazy.h"
+
+#include <stdexcept>
+
+namespace tanu::cfg {
+
+    namespace {
+        // next segment of key at pos, moving pos past it
+        std::string_view next_segment(std::string_view key, size_t& pos) {
+            const size_t slash = key.find('/', pos);
+            const std::string_view segment = key.substr(pos, slash - pos);
+            pos = slash == std::string_view::npos ? key.size() : slash + 1;
+            return segment;
+        }
+    }
+
+    CfgLazyDocument::CfgLazyDocument(std::string source):
+        m_source(std::move(source)), m_sectioned(false), m_empty(CfgIndex::parse("{}")) {
+        std::vector<CfgSectionSpan> spans;
+        m_sectioned = cfg_scan_sections(m_source, spans);
+
+        std::vector<size_t> member_count(spans.size(), 0);
+        for(const CfgSectionSpan& span : spans) {
+            if(span.parent >= 0) {
+                member_count[span.parent]++;
+            }
+        }
+        for(size_t i = 0; i < spans.size(); i++) {
+            const CfgSectionSpan& span = spans[i];
+            // a repeated top-level name keeps only its last value, as in a
+            // full parse: neither the earlier value's section nor its
+            // members are reachable. its own members come after it.
+            if(span.parent < 0) {
+                m_routes[cfg_pointer_segment(span.name)] = Route {};
+            }
+            // object-valued top-level members with members of their own are
+            // split up; everything else is one section
+            if(span.parent < 0 && member_count[i] > 0) {
+                continue;
+            }
+            auto section = std::make_unique<Section>();
+            section->text = span.text;
+            section->nested = span.parent >= 0;
+            const uint32_t id = static_cast<uint32_t>(m_sections.size());
+            if(section->nested) {
+                section->name = spans[span.parent].name;
+                section->member = span.name;
+                // a repeated name keeps its last value, as in a full parse
+                m_routes[cfg_pointer_segment(section->name)].members[cfg_pointer_segment(span.name)] = id;
+            } else {
+                section->name = span.name;
+                m_routes[cfg_pointer_segment(span.name)].section = id;
+            }
+            m_sections.push_back(std::move(section));
+        }
+    }
+
+    const CfgIndex& CfgLazyDocument::index_for(std::string_view key) const {
+        if(!m_sectioned) {
+            return whole();
+        }
+        size_t pos = key.starts_with('/') ? 1 : 0;
+        const auto route = m_routes.find(next_segment(key, pos));
+        if(route == m_routes.end()) {
+            return m_empty;
+        }
+        uint32_t id = route->second.section;
+        if(pos < key.size()) {
+            const auto member = route->second.members.find(next_segment(key, pos));
+            if(member != route->second.members.end()) {
+                id = member->second;
+            }
+        }
+        if(id == CfgIndex::npos) {
+            return m_empty;
+        }
+        Section& section = *m_sections[id];
+        const CfgIndex* ready = section.ready.load(std::memory_order_acquire);
+        return ready != nullptr ? *ready : materialize(section);
+    }
+
+    const CfgIndex& CfgLazyDocument::materialize(Section& section) const {
+        std::lock_guard<std::mutex> lock(section.mtx);
+        if(const CfgIndex* ready = section.ready.load(std::memory_order_acquire)) {
+            return *ready;
+        }
+        std::vector<std::string_view> path {section.name};
+        if(section.nested) {
+            path.push_back(section.member);
+        }
+        section.index = std::make_unique<const CfgIndex>(CfgIndex::parse_at(section.text, path));
+        section.ready.store(section.index.get(), std::memory_order_release);
+        return *section.index;
+    }
+
+    const CfgIndex& CfgLazyDocument::whole() const {
+        if(const CfgIndex* ready = m_whole_ready.load(std::memory_order_acquire)) {
+            return *ready;
+        }
+        std::lock_guard<std::mutex> lock(m_whole_mtx);
+        if(!m_whole) {
+            m_whole = std::make_unique<const CfgIndex>(CfgIndex::parse(m_source));
+            m_whole_ready.store(m_whole.get(), std::memory_order_release);
+        }
+        return *m_whole;
+    }
+
+    CfgMemoryUsage CfgLazyDocument::memory_usage() const noexcept {
+        CfgMemoryUsage usage {};
+        auto add = [&usage](const CfgIndex* index) {
+            if(index != nullptr) {
+                const CfgMemoryUsage u = index->memory_usage();
+                usage.values += u.values;
+                usage.keys += u.keys;
+                usage.strings += u.strings;
+                usage.table += u.table;
+                usage.arrays += u.arrays;
+            }
+        };
+        for(const auto& section : m_sections) {
+            add(section->ready.load(std::memory_order_acquire));
+        }
+        add(m_whole_ready.load(std::memory_order_acquire));
+        return usage;
+    }
+
+    size_t CfgLazyDocument::materialized_count() const noexcept {
+        size_t n = 0;
+        for(const auto& section : m_sections) {
+            n += section->ready.load(std::memory_order_acquire) != nullptr ? 1 : 0;
+        }
+        return n;
+    }
+
+}
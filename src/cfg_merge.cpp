@@ -0,0 +1,145 @@
+#include "cpptanu_cfg/cfg_index.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+namespace tanu::cfg {
+
+    // replays the merged document into a Builder. member names are handed
+    // over in their stored, escaped form, so nothing is unescaped and
+    // escaped again on the way.
+    class CfgIndex::Merger {
+    public:
+        // one layer's value at the path being merged
+        struct Source {
+            const CfgIndex* index;
+            uint32_t idx;
+            uint16_t layer;
+        };
+
+        Builder builder;
+        // layer of every value handed to the builder, in document order
+        std::vector<uint16_t> emitted;
+
+        // sources hold the path's value in each layer that has it, bottom first
+        void merge(std::span<const Source> sources) {
+            const Source& top = sources.back();
+            if(top.index->m_values[top.idx].type != CfgType::Object) {
+                copy(top);
+                return;
+            }
+            // lower layers show through only down to the first one where
+            // this path is not an object
+            size_t first = sources.size() - 1;
+            while(first > 0 && sources[first - 1].index->m_values[sources[first - 1].idx].type == CfgType::Object) {
+                first--;
+            }
+
+            // members in order of first appearance, each with its
+            // definitions bottom first; within a layer the last one wins
+            std::vector<std::string_view> names;
+            std::unordered_map<std::string_view, std::vector<Source>> members;
+            char buf[16];
+            for(size_t s = first; s < sources.size(); s++) {
+                const CfgIndex& index = *sources[s].index;
+                const CfgValue& obj = index.m_values[sources[s].idx];
+                for(uint32_t c = obj.range.begin; c < obj.range.begin + obj.range.count; c++) {
+                    const std::string_view name = index.segment(c, buf);
+                    auto [it, inserted] = members.try_emplace(name);
+                    if(inserted) {
+                        names.push_back(name);
+                    }
+                    const Source def {&index, c, sources[s].layer};
+                    if(!it->second.empty() && it->second.back().layer == def.layer) {
+                        it->second.back() = def;
+                    } else {
+                        it->second.push_back(def);
+                    }
+                }
+            }
+
+            emitted.push_back(top.layer);
+            builder.begin_object();
+            for(const std::string_view name : names) {
+                builder.escaped_key(name);
+                merge(members.at(name));
+            }
+            builder.end_container();
+        }
+
+        void copy(const Source& src) {
+            const CfgIndex& index = *src.index;
+            const CfgValue& v = index.m_values[src.idx];
+            emitted.push_back(src.layer);
+            switch(v.type) {
+                case CfgType::Null:
+                    builder.null_value();
+                    break;
+                case CfgType::Bool:
+                    builder.bool_value(v.b);
+                    break;
+                case CfgType::Int:
+                    builder.int_value(v.i);
+                    break;
+                case CfgType::UInt:
+                    builder.uint_value(v.u);
+                    break;
+                case CfgType::Double:
+                    builder.double_value(v.d);
+                    break;
+                case CfgType::String:
+                    builder.string_value(index.str(v));
+                    break;
+                case CfgType::Array:
+                case CfgType::Object: {
+                    if(v.type == CfgType::Array) {
+                        builder.begin_array();
+                    } else {
+                        builder.begin_object();
+                    }
+                    char buf[16];
+                    for(uint32_t c = v.range.begin; c < v.range.begin + v.range.count; c++) {
+                        if(v.type == CfgType::Object) {
+                            builder.escaped_key(index.segment(c, buf));
+                        }
+                        copy(Source {&index, c, src.layer});
+                    }
+                    builder.end_container();
+                    break;
+                }
+            }
+        }
+    };
+
+    CfgIndex CfgIndex::merge(std::span<const CfgIndex> layers, std::vector<uint16_t>& origins) {
+        if(layers.empty() || layers.size() > UINT16_MAX) {
+            throw std::runtime_error("merge needs between 1 and 65535 layers");
+        }
+        Merger merger;
+        std::vector<Merger::Source> roots;
+        for(size_t i = 0; i < layers.size(); i++) {
+            roots.push_back(Merger::Source {&layers[i], layers[i].m_root, static_cast<uint16_t>(i)});
+        }
+        merger.merge(roots);
+        CfgIndex merged = merger.builder.finish();
+
+        // values were emitted in document order; visiting the merged tree
+        // in the same order puts each layer at its value's position
+        origins.assign(merged.size(), 0);
+        size_t next = 0;
+        std::vector<uint32_t> stack {merged.m_root};
+        while(!stack.empty()) {
+            const uint32_t idx = stack.back();
+            stack.pop_back();
+            origins[idx] = merger.emitted[next++];
+            const CfgValue& v = merged.m_values[idx];
+            if(v.type == CfgType::Array || v.type == CfgType::Object) {
+                for(uint32_t c = v.range.begin + v.range.count; c > v.range.begin; c--) {
+                    stack.push_back(c - 1);
+                }
+            }
+        }
+        return merged;
+    }
+
+}
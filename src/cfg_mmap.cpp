@@ -0,0 +1,92 @@
+#include "cpptanu_cfg/cfg_mmap.h"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tanu::cfg {
+
+#ifdef __unix__
+
+    namespace {
+        bool owned_by_user(const struct stat& st) {
+            return st.st_uid == geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+        }
+    }
+
+    MappedFile::MappedFile(const std::filesystem::path& fpath, bool sequential): m_data(nullptr), m_size(0), m_owned(false) {
+        const int fd = open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0) {
+            throw std::runtime_error(std::format("open {} failed: {}", fpath.string(), std::strerror(errno)));
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            const int err = errno;
+            close(fd);
+            throw std::runtime_error(std::format("fstat {} failed: {}", fpath.string(), std::strerror(err)));
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        m_owned = owned_by_user(st);
+        if(m_size > 0) {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED) {
+                const int err = errno;
+                close(fd);
+                throw std::runtime_error(std::format("mmap {} failed: {}", fpath.string(), std::strerror(err)));
+            }
+            madvise(p, m_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            m_data = static_cast<const char*>(p);
+        }
+        close(fd);
+    }
+
+    MappedFile::MappedFile(int fd, const std::string& name): m_data(nullptr), m_size(0), m_owned(false) {
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            throw std::runtime_error(std::format("fstat {} failed: {}", name, std::strerror(errno)));
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        m_owned = owned_by_user(st);
+        if(m_size > 0) {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if(p == MAP_FAILED) {
+                throw std::runtime_error(std::format("mmap {} failed: {}", name, std::strerror(errno)));
+            }
+            m_data = static_cast<const char*>(p);
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if(m_data != nullptr && m_fallback.empty()) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::filesystem::path& fpath, bool): m_data(nullptr), m_size(0), m_owned(true) {
+        std::ifstream ifs(fpath, std::ios::binary);
+        if(!ifs) {
+            throw std::runtime_error(std::format("open {} failed", fpath.string()));
+        }
+        m_fallback.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        m_data = m_fallback.data();
+        m_size = m_fallback.size();
+    }
+
+    MappedFile::~MappedFile() {
+    }
+
+#endif
+
+}
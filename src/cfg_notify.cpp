@@ -0,0 +1,119 @@
+#include "cpptanu_cfg/cfg_notify.h"
+
+#include <algorithm>
+
+namespace tanu::cfg {
+
+    namespace {
+        const CfgIndex& whole_or_empty(const std::shared_ptr<const CfgSnapshot>& snapshot) {
+            static const CfgIndex empty = CfgIndex::parse("{}");
+            return snapshot ? snapshot->whole() : empty;
+        }
+    }
+
+    CfgNotifier::CfgNotifier(std::shared_ptr<const CfgSnapshot> base, uint64_t base_version):
+        m_posted(base_version), m_dispatched(base_version), m_next_id(1), m_stop(false), m_base(std::move(base)) {
+        m_thread = std::thread(&CfgNotifier::run, this);
+    }
+
+    CfgNotifier::~CfgNotifier() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    uint64_t CfgNotifier::subscribe(std::string prefix, Callback callback) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        const uint64_t id = m_next_id++;
+        m_subscribers.push_back(Subscriber {id, std::move(prefix), std::make_shared<const Callback>(std::move(callback))});
+        return id;
+    }
+
+    void CfgNotifier::unsubscribe(uint64_t id) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            std::erase_if(m_subscribers, [id](const Subscriber& s) { return s.id == id; });
+        }
+        if(std::this_thread::get_id() != m_thread.get_id()) {
+            // a dispatch that already picked the callback up finishes first
+            std::lock_guard<std::mutex> wait(m_dispatch_mtx);
+        }
+    }
+
+    void CfgNotifier::post(std::shared_ptr<const CfgSnapshot> snapshot, uint64_t version) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_latest = std::move(snapshot);
+            m_posted = version;
+        }
+        m_cv.notify_all();
+    }
+
+    void CfgNotifier::flush() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        const uint64_t target = m_posted;
+        m_cv.wait(lock, [&] { return m_stop || m_dispatched >= target; });
+    }
+
+    void CfgNotifier::run() {
+        while(true) {
+            std::shared_ptr<const CfgSnapshot> next;
+            uint64_t version;
+            std::vector<Subscriber> subscribers;
+            {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                m_cv.wait(lock, [&] { return m_stop || m_posted != m_dispatched; });
+                if(m_stop) {
+                    return;
+                }
+                next = std::move(m_latest);
+                version = m_posted;
+                subscribers = m_subscribers;
+            }
+
+            if(!subscribers.empty()) {
+                CfgDiff diff;
+                try {
+                    diff = cfg_diff(whole_or_empty(m_base), whole_or_empty(next));
+                } catch(const std::exception&) {
+                    // a lazy version whose full parse fails has no diff;
+                    // getters report it
+                }
+                diff.to_version = version;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    diff.from_version = m_dispatched;
+                }
+                std::lock_guard<std::mutex> dispatching(m_dispatch_mtx);
+                for(const Subscriber& s : subscribers) {
+                    CfgDiff mine = s.prefix.empty() ? diff : diff.under(s.prefix);
+                    if(mine.empty()) {
+                        continue;
+                    }
+                    {
+                        // skip anyone unsubscribed since the copy was taken
+                        std::lock_guard<std::mutex> lock(m_mtx);
+                        if(std::none_of(m_subscribers.begin(), m_subscribers.end(), [&s](const Subscriber& cur) { return cur.id == s.id; })) {
+                            continue;
+                        }
+                    }
+                    try {
+                        (*s.callback)(mine);
+                    } catch(...) {
+                        // one subscriber's failure doesn't cost the others
+                    }
+                }
+            }
+            m_base = std::move(next);
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_dispatched = version;
+            }
+            m_cv.notify_all();
+        }
+    }
+
+}
@@ -0,0 +1,134 @@
+#include "cpptanu_cfg/cfg_numeric.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define TANU_CFG_X86_KERNELS
+#endif
+
+namespace tanu::cfg {
+
+    namespace {
+        template<typename In, typename Out>
+        void convert_scalar(const In* in, Out* out, size_t n) noexcept {
+            for(size_t i = 0; i < n; i++) {
+                out[i] = static_cast<Out>(in[i]);
+            }
+        }
+
+#ifdef TANU_CFG_X86_KERNELS
+        // each kernel does whole vectors and leaves the tail to the scalar loop
+
+        __attribute__((target("avx2")))
+        void double_to_float_avx2(const double* in, float* out, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 4 <= n; i += 4) {
+                _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i)));
+            }
+            convert_scalar(in + i, out + i, n - i);
+        }
+
+        __attribute__((target("avx512f")))
+        void double_to_float_avx512(const double* in, float* out, size_t n) noexcept {
+            size_t i = 0;
+            // the masked form: gcc 12 warns about the unmasked one's
+            // deliberately undefined pass-through register
+            const __m256 zero = _mm256_setzero_ps();
+            for(; i + 8 <= n; i += 8) {
+                _mm256_storeu_ps(out + i, _mm512_mask_cvtpd_ps(zero, 0xff, _mm512_loadu_pd(in + i)));
+            }
+            convert_scalar(in + i, out + i, n - i);
+        }
+
+        // avx2 has no int64 -> floating point conversion; only avx512dq does
+        __attribute__((target("avx512f,avx512dq")))
+        void int_to_double_avx512(const int64_t* in, double* out, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8) {
+                _mm512_storeu_pd(out + i, _mm512_cvtepi64_pd(_mm512_loadu_si512(in + i)));
+            }
+            convert_scalar(in + i, out + i, n - i);
+        }
+
+        __attribute__((target("avx512f,avx512dq")))
+        void int_to_float_avx512(const int64_t* in, float* out, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8) {
+                _mm256_storeu_ps(out + i, _mm512_cvtepi64_ps(_mm512_loadu_si512(in + i)));
+            }
+            convert_scalar(in + i, out + i, n - i);
+        }
+#endif
+
+        CfgSimd detect() noexcept {
+#ifdef TANU_CFG_X86_KERNELS
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+                return CfgSimd::Avx512;
+            }
+            if(__builtin_cpu_supports("avx2")) {
+                return CfgSimd::Avx2;
+            }
+#endif
+            return CfgSimd::Scalar;
+        }
+    }
+
+    CfgSimd cfg_simd_level() noexcept {
+        static const CfgSimd level = detect();
+        return level;
+    }
+
+#ifdef TANU_CFG_X86_KERNELS
+    namespace {
+        CfgSimd usable(CfgSimd level) noexcept {
+            return std::min(level, cfg_simd_level());
+        }
+    }
+#endif
+
+    const char* cfg_simd_name(CfgSimd level) noexcept {
+        switch(level) {
+            case CfgSimd::Avx2:
+                return "avx2";
+            case CfgSimd::Avx512:
+                return "avx512";
+            default:
+                return "scalar";
+        }
+    }
+
+    void cfg_convert(std::span<const double> in, float* out, CfgSimd level) noexcept {
+#ifdef TANU_CFG_X86_KERNELS
+        switch(usable(level)) {
+            case CfgSimd::Avx512:
+                return double_to_float_avx512(in.data(), out, in.size());
+            case CfgSimd::Avx2:
+                return double_to_float_avx2(in.data(), out, in.size());
+            default:
+                break;
+        }
+#endif
+        convert_scalar(in.data(), out, in.size());
+    }
+
+    void cfg_convert(std::span<const int64_t> in, double* out, CfgSimd level) noexcept {
+#ifdef TANU_CFG_X86_KERNELS
+        if(usable(level) == CfgSimd::Avx512) {
+            return int_to_double_avx512(in.data(), out, in.size());
+        }
+#endif
+        convert_scalar(in.data(), out, in.size());
+    }
+
+    void cfg_convert(std::span<const int64_t> in, float* out, CfgSimd level) noexcept {
+#ifdef TANU_CFG_X86_KERNELS
+        if(usable(level) == CfgSimd::Avx512) {
+            return int_to_float_avx512(in.data(), out, in.size());
+        }
+#endif
+        convert_scalar(in.data(), out, in.size());
+    }
+
+}
@@ -0,0 +1,464 @@
+#include "cpptanu_cfg/cfg_index.h"
+#include "cpptanu_cfg/cfg_lazy.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace tanu::cfg {
+
+    namespace {
+
+        // read position in json text and the lexing both passes below share
+        class JsonCursor {
+        protected:
+            const char* const m_begin;
+            const char* const m_end;
+            const char* m_p;
+            std::string m_scratch;
+
+            explicit JsonCursor(std::string_view text):
+                m_begin(text.data()), m_end(text.data() + text.size()), m_p(text.data()) {}
+
+            [[noreturn]] void fail(const char* what) const {
+                throw std::runtime_error(std::format("json parse error at byte {}: {}", m_p - m_begin, what));
+            }
+
+            void skip_ws() {
+                while(m_p < m_end && (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t')) {
+                    m_p++;
+                }
+            }
+
+            void expect(char c, const char* what) {
+                skip_ws();
+                if(m_p >= m_end || *m_p != c) {
+                    fail(what);
+                }
+                m_p++;
+            }
+
+            static int hex_value(char c) {
+                if(c >= '0' && c <= '9') return c - '0';
+                if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+                return -1;
+            }
+
+            uint32_t parse_hex4() {
+                if(m_end - m_p < 4) {
+                    fail("truncated \\u escape");
+                }
+                uint32_t cp = 0;
+                for(int i = 0; i < 4; i++) {
+                    const int h = hex_value(m_p[i]);
+                    if(h < 0) {
+                        fail("invalid \\u escape");
+                    }
+                    cp = (cp << 4) | static_cast<uint32_t>(h);
+                }
+                m_p += 4;
+                return cp;
+            }
+
+            void append_utf8(uint32_t cp) {
+                if(cp < 0x80) {
+                    m_scratch.push_back(static_cast<char>(cp));
+                } else if(cp < 0x800) {
+                    m_scratch.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                    m_scratch.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                } else if(cp < 0x10000) {
+                    m_scratch.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                    m_scratch.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                    m_scratch.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                } else {
+                    m_scratch.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                    m_scratch.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                    m_scratch.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                    m_scratch.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                }
+            }
+
+            // m_p is on the opening quote. the view is valid until the next
+            // call, it either points into the input or into m_scratch.
+            std::string_view parse_string() {
+                const char* start = ++m_p;
+                while(m_p < m_end && *m_p != '"' && *m_p != '\\' && static_cast<unsigned char>(*m_p) >= 0x20) {
+                    m_p++;
+                }
+                if(m_p < m_end && *m_p == '"') {
+                    return std::string_view(start, m_p++ - start);
+                }
+
+                m_scratch.assign(start, m_p);
+                while(true) {
+                    if(m_p >= m_end) {
+                        fail("unterminated string");
+                    }
+                    const char c = *m_p++;
+                    if(c == '"') {
+                        return m_scratch;
+                    }
+                    if(static_cast<unsigned char>(c) < 0x20) {
+                        fail("control character in string");
+                    }
+                    if(c != '\\') {
+                        m_scratch.push_back(c);
+                        continue;
+                    }
+                    if(m_p >= m_end) {
+                        fail("unterminated escape");
+                    }
+                    switch(*m_p++) {
+                        case '"': m_scratch.push_back('"'); break;
+                        case '\\': m_scratch.push_back('\\'); break;
+                        case '/': m_scratch.push_back('/'); break;
+                        case 'b': m_scratch.push_back('\b'); break;
+                        case 'f': m_scratch.push_back('\f'); break;
+                        case 'n': m_scratch.push_back('\n'); break;
+                        case 'r': m_scratch.push_back('\r'); break;
+                        case 't': m_scratch.push_back('\t'); break;
+                        case 'u': {
+                            uint32_t cp = parse_hex4();
+                            if(cp >= 0xDC00 && cp <= 0xDFFF) {
+                                fail("lone low surrogate");
+                            }
+                            if(cp >= 0xD800 && cp <= 0xDBFF) {
+                                if(m_end - m_p < 2 || m_p[0] != '\\' || m_p[1] != 'u') {
+                                    fail("missing low surrogate");
+                                }
+                                m_p += 2;
+                                const uint32_t low = parse_hex4();
+                                if(low < 0xDC00 || low > 0xDFFF) {
+                                    fail("invalid low surrogate");
+                                }
+                                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            append_utf8(cp);
+                            break;
+                        }
+                        default:
+                            fail("invalid escape");
+                    }
+                }
+            }
+
+            void skip_bom() {
+                if(m_end - m_p >= 3 && std::memcmp(m_p, "\xEF\xBB\xBF", 3) == 0) {
+                    m_p += 3;
+                }
+            }
+        };
+
+        // single pass over json text that feeds a CfgIndex::Builder. nesting is
+        // tracked on an explicit stack, strings without escapes are handed to
+        // the builder as views of the input, and numbers go through
+        // std::from_chars.
+        class JsonTokenizer : private JsonCursor {
+        private:
+            CfgIndex::Builder& m_builder;
+            std::vector<char> m_stack;
+
+            void parse_number() {
+                const char* start = m_p;
+                bool is_float = false;
+                auto digits = [&] {
+                    const char* d = m_p;
+                    while(m_p < m_end && *m_p >= '0' && *m_p <= '9') {
+                        m_p++;
+                    }
+                    if(m_p == d) {
+                        fail("digit expected");
+                    }
+                };
+                if(*m_p == '-') {
+                    m_p++;
+                }
+                if(m_p < m_end && *m_p == '0') {
+                    m_p++;
+                } else {
+                    digits();
+                }
+                if(m_p < m_end && *m_p == '.') {
+                    m_p++;
+                    digits();
+                    is_float = true;
+                }
+                if(m_p < m_end && (*m_p == 'e' || *m_p == 'E')) {
+                    m_p++;
+                    if(m_p < m_end && (*m_p == '+' || *m_p == '-')) {
+                        m_p++;
+                    }
+                    digits();
+                    is_float = true;
+                }
+
+                if(!is_float) {
+                    int64_t i;
+                    if(std::from_chars(start, m_p, i).ec == std::errc {}) {
+                        m_builder.int_value(i);
+                        return;
+                    }
+                    uint64_t u;
+                    if(*start != '-' && std::from_chars(start, m_p, u).ec == std::errc {}) {
+                        m_builder.uint_value(u);
+                        return;
+                    }
+                    // too large for either integer type; json::parse falls
+                    // back to a double as well
+                }
+                double d;
+                if(std::from_chars(start, m_p, d).ec != std::errc {}) {
+                    // out of range: let strtod saturate to inf or 0 like json::parse
+                    d = std::strtod(std::string(start, m_p).c_str(), nullptr);
+                }
+                m_builder.double_value(d);
+            }
+
+            void parse_literal(const char* lit, size_t len) {
+                if(static_cast<size_t>(m_end - m_p) < len || std::memcmp(m_p, lit, len) != 0) {
+                    fail("invalid literal");
+                }
+                m_p += len;
+            }
+
+            void parse_key() {
+                skip_ws();
+                if(m_p >= m_end || *m_p != '"') {
+                    fail("object key expected");
+                }
+                m_builder.key(parse_string());
+                expect(':', "':' expected");
+            }
+
+        public:
+            JsonTokenizer(std::string_view text, CfgIndex::Builder& builder): JsonCursor(text), m_builder(builder) {}
+
+            void run() {
+                skip_bom();
+                while(true) {
+                    // a value is expected here
+                    skip_ws();
+                    if(m_p >= m_end) {
+                        fail("value expected");
+                    }
+                    bool opened = false;
+                    switch(*m_p) {
+                        case '{':
+                            m_p++;
+                            m_builder.begin_object();
+                            m_stack.push_back('}');
+                            skip_ws();
+                            if(m_p < m_end && *m_p == '}') {
+                                break;
+                            }
+                            parse_key();
+                            opened = true;
+                            break;
+                        case '[':
+                            m_p++;
+                            m_builder.begin_array();
+                            m_stack.push_back(']');
+                            skip_ws();
+                            if(m_p < m_end && *m_p == ']') {
+                                break;
+                            }
+                            opened = true;
+                            break;
+                        case '"':
+                            m_builder.string_value(parse_string());
+                            break;
+                        case 't':
+                            parse_literal("true", 4);
+                            m_builder.bool_value(true);
+                            break;
+                        case 'f':
+                            parse_literal("false", 5);
+                            m_builder.bool_value(false);
+                            break;
+                        case 'n':
+                            parse_literal("null", 4);
+                            m_builder.null_value();
+                            break;
+                        default:
+                            if(*m_p == '-' || (*m_p >= '0' && *m_p <= '9')) {
+                                parse_number();
+                            } else {
+                                fail("value expected");
+                            }
+                    }
+                    if(opened) {
+                        continue;
+                    }
+
+                    // after a value: close containers or move to the next member
+                    while(true) {
+                        skip_ws();
+                        if(m_stack.empty()) {
+                            if(m_p != m_end) {
+                                fail("trailing characters after the document");
+                            }
+                            return;
+                        }
+                        if(m_p >= m_end) {
+                            fail("unexpected end of input");
+                        }
+                        if(*m_p == m_stack.back()) {
+                            m_p++;
+                            m_stack.pop_back();
+                            m_builder.end_container();
+                            continue;
+                        }
+                        if(*m_p != ',') {
+                            fail(m_stack.back() == '}' ? "',' or '}' expected" : "',' or ']' expected");
+                        }
+                        m_p++;
+                        if(m_stack.back() == '}') {
+                            parse_key();
+                        }
+                        break;
+                    }
+                }
+            }
+        };
+
+
+        // skips over values instead of tokenizing them, recording where the
+        // members of the top two object levels start and end
+        class SectionScanner : private JsonCursor {
+        private:
+            std::vector<CfgSectionSpan>& m_out;
+
+            void skip_string() {
+                for(m_p++; m_p < m_end && *m_p != '"'; m_p++) {
+                    if(*m_p == '\\') {
+                        m_p++;
+                    }
+                }
+                if(m_p >= m_end) {
+                    fail("unterminated string");
+                }
+                m_p++;
+            }
+
+            void skip_value() {
+                if(m_p >= m_end) {
+                    fail("value expected");
+                }
+                if(*m_p == '"') {
+                    skip_string();
+                    return;
+                }
+                if(*m_p == '{' || *m_p == '[') {
+                    size_t depth = 0;
+                    do {
+                        if(m_p >= m_end) {
+                            fail("unexpected end of input");
+                        }
+                        if(*m_p == '"') {
+                            skip_string();
+                            continue;
+                        }
+                        if(*m_p == '{' || *m_p == '[') {
+                            depth++;
+                        } else if(*m_p == '}' || *m_p == ']') {
+                            depth--;
+                        }
+                        m_p++;
+                    } while(depth > 0);
+                    return;
+                }
+                const char* start = m_p;
+                while(m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']'
+                        && *m_p != ' ' && *m_p != '\n' && *m_p != '\r' && *m_p != '\t') {
+                    m_p++;
+                }
+                if(m_p == start) {
+                    fail("value expected");
+                }
+            }
+
+            // m_p is on the opening brace
+            void scan_object(int32_t parent) {
+                m_p++;
+                skip_ws();
+                if(m_p < m_end && *m_p == '}') {
+                    m_p++;
+                    return;
+                }
+                while(true) {
+                    skip_ws();
+                    if(m_p >= m_end || *m_p != '"') {
+                        fail("object key expected");
+                    }
+                    std::string name {parse_string()};
+                    expect(':', "':' expected");
+                    skip_ws();
+                    const char* start = m_p;
+                    if(parent < 0 && m_p < m_end && *m_p == '{') {
+                        const int32_t self = static_cast<int32_t>(m_out.size());
+                        m_out.push_back(CfgSectionSpan {std::move(name), {}, parent});
+                        scan_object(self);
+                        m_out[self].text = std::string_view(start, m_p - start);
+                    } else {
+                        skip_value();
+                        m_out.push_back(CfgSectionSpan {std::move(name), std::string_view(start, m_p - start), parent});
+                    }
+                    skip_ws();
+                    if(m_p < m_end && *m_p == ',') {
+                        m_p++;
+                    } else if(m_p < m_end && *m_p == '}') {
+                        m_p++;
+                        return;
+                    } else {
+                        fail("',' or '}' expected");
+                    }
+                }
+            }
+
+        public:
+            SectionScanner(std::string_view text, std::vector<CfgSectionSpan>& out): JsonCursor(text), m_out(out) {}
+
+            bool run() {
+                skip_bom();
+                skip_ws();
+                if(m_p >= m_end || *m_p != '{') {
+                    return false;
+                }
+                scan_object(-1);
+                skip_ws();
+                if(m_p != m_end) {
+                    fail("trailing characters after the document");
+                }
+                return true;
+            }
+        };
+
+    }
+
+    bool cfg_scan_sections(std::string_view text, std::vector<CfgSectionSpan>& out) {
+        return SectionScanner(text, out).run();
+    }
+
+    CfgIndex CfgIndex::parse_at(std::string_view text, std::span<const std::string_view> path) {
+        Builder builder;
+        for(const std::string_view name : path) {
+            builder.begin_object();
+            builder.key(name);
+        }
+        JsonTokenizer(text, builder).run();
+        for(size_t i = 0; i < path.size(); i++) {
+            builder.end_container();
+        }
+        return builder.finish();
+    }
+
+    CfgIndex CfgIndex::parse(std::string_view text) {
+        Builder builder;
+        JsonTokenizer(text, builder).run();
+        return builder.finish();
+    }
+
+}
@@ -0,0 +1,93 @@
+#include "cpptanu_cfg/cfg_index.h"
+
+namespace tanu::cfg {
+
+    namespace {
+        bool is_container(const CfgValue& v) {
+            return v.type == CfgType::Array || v.type == CfgType::Object;
+        }
+    }
+
+    CfgEntry CfgPathRange::iterator::operator*() const noexcept {
+        return CfgEntry {m_path, m_index->m_values[m_current]};
+    }
+
+    CfgPathRange::iterator& CfgPathRange::iterator::operator++() {
+        m_current = UINT32_MAX;
+        char buf[16];
+        while(!m_stack.empty()) {
+            const Pending p = m_stack.back();
+            m_stack.pop_back();
+            m_path.resize(p.path_len);
+            m_path.push_back('/');
+            m_path.append(m_index->segment(p.idx, buf));
+
+            const CfgValue& v = m_index->m_values[p.idx];
+            if(!is_container(v) || v.range.count == 0) {
+                m_current = p.idx;
+                return *this;
+            }
+            const uint32_t path_len = static_cast<uint32_t>(m_path.size());
+            for(uint32_t c = v.range.begin + v.range.count; c > v.range.begin; c--) {
+                m_stack.push_back(Pending {c - 1, path_len});
+            }
+        }
+        return *this;
+    }
+
+    CfgPathRange::iterator CfgPathRange::begin() const {
+        iterator it;
+        if(m_index == nullptr) {
+            return it;
+        }
+        it.m_index = m_index;
+        it.m_path = m_base;
+        const uint32_t base_len = static_cast<uint32_t>(m_base.size());
+        if(m_self) {
+            it.m_stack.push_back(iterator::Pending {m_node, base_len});
+        } else {
+            const CfgValue& v = m_index->m_values[m_node];
+            char buf[16];
+            for(uint32_t c = v.range.begin + v.range.count; c > v.range.begin; c--) {
+                if(m_index->segment(c - 1, buf).starts_with(m_partial)) {
+                    it.m_stack.push_back(iterator::Pending {c - 1, base_len});
+                }
+            }
+        }
+        ++it;
+        return it;
+    }
+
+    CfgPathRange CfgIndex::with_prefix(std::string_view prefix) const {
+        if(prefix.starts_with('/')) {
+            prefix.remove_prefix(1);
+        }
+        const size_t slash = prefix.rfind('/');
+        if(slash == std::string_view::npos) {
+            return is_container(root()) ? CfgPathRange(this, m_root, false, "", prefix) : CfgPathRange();
+        }
+        const std::string_view parent_key = prefix.substr(0, slash);
+        const CfgValue* parent = find(parent_key);
+        if(parent == nullptr || !is_container(*parent)) {
+            return CfgPathRange();
+        }
+        return CfgPathRange(this, position(*parent), false, "/" + std::string {parent_key}, prefix.substr(slash + 1));
+    }
+
+    CfgPathRange CfgIndex::subtree(std::string_view key) const {
+        if(key.starts_with('/')) {
+            key.remove_prefix(1);
+        }
+        if(key.empty()) {
+            return is_container(root()) ? CfgPathRange(this, m_root, false, "", "") : CfgPathRange();
+        }
+        const CfgValue* node = find(key);
+        if(node == nullptr) {
+            return CfgPathRange();
+        }
+        const size_t slash = key.rfind('/');
+        const std::string base = slash == std::string_view::npos ? "" : "/" + std::string {key.substr(0, slash)};
+        return CfgPathRange(this, position(*node), true, base, "");
+    }
+
+}
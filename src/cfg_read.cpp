@@ -6,224 +6,1050 @@
 #include <memory>
 #include <stdexcept>
 #include <format>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <type_traits>
 
 namespace tanu::cfg {
 
+    namespace {
+        std::string normalized_key(std::string_view key) {
+            std::string k {key};
+            if(k.empty() || k.front() != '/') k.insert(k.begin(), '/');
+            return k;
+        }
+
+        // message is kept identical to what json::at() used to report
+        [[noreturn]] void throw_key_not_found(std::string_view key) {
+            throw TanuCfgException(std::format("json::exception -> [json.exception.out_of_range.403] key '{}' not found", normalized_key(key)));
+        }
+
+        [[noreturn]] void throw_vec_key_not_found(std::string_view key) {
+            throw TanuCfgException(std::format("key \'{}\' not found", normalized_key(key)));
+        }
+
+        bool is_integer(const CfgValue& v) {
+            return v.type == CfgType::Int || v.type == CfgType::UInt;
+        }
+
+        bool fits_int(int64_t i) {
+            return i >= std::numeric_limits<int>::min() && i <= std::numeric_limits<int>::max();
+        }
+    }
+
     void JSONConfig::load(const std::string& file_name) {
         const std::filesystem::path fpath = (std::filesystem::path(this->conf_dir) / file_name);
         if(!std::filesystem::exists(fpath)) {
             throw TanuCfgException(fpath.string() + " does not exist");
         }
+        std::shared_ptr<const CfgSnapshot> snapshot;
         try {
-            std::ifstream ifs(fpath);
-            json loaded = json::parse(ifs);
-            this->m_cfg_flattened_view = std::make_unique<json>(loaded.flatten());
-            this->m_loaded_cfg = std::make_unique<json>(loaded);
+            snapshot = read_snapshot(fpath);
+        } catch(const TanuCfgException&) {
+            throw;
         } catch(...) {
             throw TanuCfgException("Json file loading/parsing failed");
         }
+        publish(std::move(snapshot));
     }
 
-    std::optional<std::string> JSONConfig::dump_cfg() {
-        if(this->m_loaded_cfg != nullptr) {
-            return this->m_loaded_cfg.get()->dump();
-        } else {
-            return std::nullopt;
-        }
+    std::future<void> JSONConfig::load_async(const std::string& file_name) {
+        return std::async(std::launch::async, [this, file_name] {
+            load(file_name);
+        });
     }
 
-    std::optional<std::string> JSONConfig::dump_flattened_view() {
-        if(this->m_cfg_flattened_view != nullptr) {
-            return this->m_cfg_flattened_view.get()->dump();
-        } else {
-            return std::nullopt;
+    void JSONConfig::load_layers(const std::vector<std::string>& file_names) {
+        std::vector<std::filesystem::path> fpaths;
+        for(const std::string& file_name : file_names) {
+            fpaths.push_back(std::filesystem::path(this->conf_dir) / file_name);
+            if(!std::filesystem::exists(fpaths.back())) {
+                throw TanuCfgException(fpaths.back().string() + " does not exist");
+            }
+        }
+        CfgLoadPhases phases;
+        std::shared_ptr<const CfgSnapshot> snapshot;
+        try {
+            snapshot = CfgSnapshot::from_layers(fpaths, this->m_stats ? &phases : nullptr);
+        } catch(...) {
+            throw TanuCfgException("Json file loading/parsing failed");
         }
+        if(this->m_stats) {
+            this->m_stats->record_load(phases);
+        }
+        check_schema(*snapshot, fpaths.back().string());
+        publish(std::move(snapshot));
     }
 
-    int JSONConfig::get_as_int(const std::string& key_o) {
+    void JSONConfig::load_schema(const std::string& file_name) {
+        const std::filesystem::path fpath = (std::filesystem::path(this->conf_dir) / file_name);
+        std::ifstream in(fpath);
+        if(!in) {
+            throw TanuCfgException(fpath.string() + " does not exist");
+        }
         try {
-            if(this->m_loaded_cfg == nullptr || this->m_cfg_flattened_view == nullptr) {
-                throw TanuCfgException("Json config hasn't loaded yet");
-            }
-            std::string key = key_o;
-            if(key.front() != '/') key.insert(key.begin(), '/');
-            auto v = this->m_cfg_flattened_view.get()->at(key);
-            if(!v.is_number_integer()) {
-                throw TanuCfgException(key + "'s value is not integer");
-            }
-            return v;
-        } catch(const json::exception& json_ex) {
-            throw TanuCfgException(std::format("json::exception -> {}", json_ex.what()));
-        } catch(const TanuCfgException& ex) {
-            throw;
-        } catch(...) {
-            std::exception_ptr ex_p = std::current_exception();
-            std::rethrow_exception(ex_p);            
-        } 
+            set_schema(std::make_shared<const CfgSchema>(CfgSchema::compile(json::parse(in))));
+        } catch(const std::exception& ex) {
+            throw TanuCfgException(std::format("schema {} is invalid: {}", fpath.string(), ex.what()));
+        }
     }
 
-    std::string JSONConfig::get_as_str(const std::string& key_o) {
+    void JSONConfig::check_schema(const CfgSnapshot& snapshot, std::string_view source) const {
+        const std::shared_ptr<const CfgSchema> schema = this->m_schema.load(std::memory_order_acquire);
+        if(!schema) {
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<std::string> errors = schema->validate(whole_index(snapshot));
+        if(this->m_stats) {
+            this->m_stats->record_phase(CfgLoadPhase::Validate, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        }
+        if(errors.empty()) {
+            return;
+        }
+        std::string reason = std::format("{} does not match the schema", source);
+        for(const std::string& error : errors) {
+            reason.append("\n  ").append(error);
+        }
+        throw TanuCfgException(reason);
+    }
+
+    std::optional<std::string> JSONConfig::provenance(std::string_view key) {
+        const std::shared_ptr<const CfgSnapshot>& snapshot = current();
+        const CfgValue* v = snapshot->index.find(key, cfg_key_hash(key));
+        if(v == nullptr || snapshot->layers.empty()) {
+            return std::nullopt;
+        }
+        return snapshot->layers[snapshot->origins[snapshot->index.position(*v)]];
+    }
+
+    const CfgIndex& JSONConfig::lazy_index_for(const CfgSnapshot& snapshot, std::string_view key) {
         try {
-            if(this->m_loaded_cfg == nullptr || this->m_cfg_flattened_view == nullptr) {
-                throw TanuCfgException("Json config hasn't loaded yet");
-            }
-            std::string key = key_o;
-            if(key.front() != '/') key.insert(key.begin(), '/');
-            auto v = this->m_cfg_flattened_view.get()->at(key);
-            if(!v.is_string()) {
-                throw TanuCfgException(key + "'s value is not string");
-            }
-            return v;
-        } catch(const json::exception& json_ex) { 
-            throw TanuCfgException(std::format("json::exception -> {}", json_ex.what()));
-        } catch(const TanuCfgException& ex) {
-            throw;
-        } catch(...) {
-            std::exception_ptr ex_p = std::current_exception();
-            std::rethrow_exception(ex_p);            
+            return snapshot.lazy->index_for(key);
+        } catch(const std::exception&) {
+            throw TanuCfgException("Json file loading/parsing failed");
         }
     }
 
-    double JSONConfig::get_as_double(const std::string& key_o) {
-        std::string key = key_o;
+    const CfgIndex* JSONConfig::try_index_for(const CfgSnapshot& snapshot, std::string_view key) noexcept {
+        if(!snapshot.lazy) {
+            return &snapshot.index;
+        }
         try {
-            if(this->m_loaded_cfg == nullptr || this->m_cfg_flattened_view == nullptr) {
-                throw TanuCfgException("Json config hasn't loaded yet");
-            }
-            if(key.front() != '/') key.insert(key.begin(), '/');
-            auto v = this->m_cfg_flattened_view.get()->at(key);
-            if(!v.is_number_float()) {
-                throw TanuCfgException(key + "'s value is not double");
-            }
-            return v;
-        } catch(const json::exception& json_ex) { 
-            throw TanuCfgException(std::format("json::exception -> {}", json_ex.what()));
-        } catch(const TanuCfgException& e) {
-            throw;
-        } catch(...) {
-            std::exception_ptr ex_p = std::current_exception();
-            std::rethrow_exception(ex_p);            
+            return &snapshot.lazy->index_for(key);
+        } catch(const std::exception&) {
+            return nullptr;
         }
     }
 
-    std::vector<double> JSONConfig::get_as_double_vec(const std::string& key_o) {
-        std::string key_base = key_o;
-        std::string key {};
-        int idx = 0;
+    const CfgIndex& JSONConfig::whole_index(const CfgSnapshot& snapshot) {
         try {
+            return snapshot.whole();
+        } catch(const std::exception&) {
+            throw TanuCfgException("Json file loading/parsing failed");
+        }
+    }
 
-            if(this->m_loaded_cfg == nullptr || this->m_cfg_flattened_view == nullptr) {
-                throw TanuCfgException("Json config hasn't loaded yet");
+    std::shared_ptr<const CfgSnapshot> JSONConfig::read_snapshot(const std::filesystem::path& fpath) const {
+        CfgLoadPhases phases;
+        CfgLoadPhases* const timings = this->m_stats ? &phases : nullptr;
+        CfgLoadMode mode = CfgLoadMode::Parse;
+        if(this->m_use_shared.load(std::memory_order_relaxed)) {
+            mode = CfgLoadMode::Shared;
+        } else if(this->m_use_image.load(std::memory_order_relaxed)) {
+            mode = CfgLoadMode::Image;
+        } else if(this->m_lazy.load(std::memory_order_relaxed)) {
+            mode = CfgLoadMode::Lazy;
+        }
+        // a snapshot shared through the registry costs this config nothing
+        bool loaded = false;
+        auto load = [&]() -> std::shared_ptr<const CfgSnapshot> {
+            loaded = true;
+            switch(mode) {
+                case CfgLoadMode::Shared:
+                    return CfgSnapshot::from_shared(fpath, timings);
+                case CfgLoadMode::Image:
+                    return CfgSnapshot::from_file(fpath, true, timings);
+                case CfgLoadMode::Lazy:
+                    return CfgSnapshot::from_file_lazy(fpath, timings);
+                default:
+                    return CfgSnapshot::from_file(fpath, false, timings);
             }
+        };
+        const std::shared_ptr<const CfgSnapshot> snapshot = this->m_use_registry.load(std::memory_order_relaxed)
+            ? CfgRegistry::instance().acquire(fpath, mode, load)
+            : load();
+        if(this->m_stats && loaded) {
+            this->m_stats->record_load(phases);
+        }
+        check_schema(*snapshot, fpath.string());
+        return snapshot;
+    }
 
-            if(key_base.front() != '/') key_base.insert(key_base.begin(), '/');
+    namespace {
+        // per-thread cache of the last snapshot each config handed to this
+        // thread, one entry per reader slot, so a config's spans never go
+        // away because another config was read. entries are only ever written
+        // by their own thread and each sits on its own cache line; a deque
+        // keeps the references current() hands out stable while it grows.
+        struct alignas(64) ReaderCacheEntry {
+            uint64_t instance_id = 0;
+            uint64_t version = 0;
+            std::shared_ptr<const CfgSnapshot> snapshot;
+        };
+        thread_local std::deque<ReaderCacheEntry> t_reader_cache;
 
-            std::vector<double> rez_v;
-            while(true) {
-                key = std::format("{}/{}", key_base, idx);
-                if(this->m_cfg_flattened_view.get()->contains(key)) {
-                    auto v = this->m_cfg_flattened_view.get()->at(key);
-                    if(!v.is_number_float()) {
-                        throw TanuCfgException(key_base + "'s value is not double");
-                    }
-                    rez_v.push_back(v);
-                    idx++;
-                } else {
-                    break;
-                }
+        // slots of destroyed configs are reused, so the caches stay as large
+        // as the most configs alive at once
+        struct ReaderSlots {
+            std::mutex mtx;
+            std::vector<size_t> free;
+            size_t count = 0;
+        };
+        // never destroyed, so configs with static storage can still release
+        // their slot at exit
+        ReaderSlots& reader_slots() {
+            static ReaderSlots* slots = new ReaderSlots;
+            return *slots;
+        }
+    }
+
+    uint64_t JSONConfig::next_instance_id() {
+        static std::atomic<uint64_t> last_id {0};
+        return last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    size_t JSONConfig::acquire_reader_slot() {
+        ReaderSlots& slots = reader_slots();
+        std::lock_guard<std::mutex> lock(slots.mtx);
+        if(slots.free.empty()) {
+            // room for every slot to come back without allocating
+            slots.free.reserve(slots.count + 1);
+            return slots.count++;
+        }
+        const size_t slot = slots.free.back();
+        slots.free.pop_back();
+        return slot;
+    }
+
+    void JSONConfig::release_reader_slot(size_t slot) noexcept {
+        ReaderSlots& slots = reader_slots();
+        std::lock_guard<std::mutex> lock(slots.mtx);
+        slots.free.push_back(slot);
+    }
+
+    std::unique_ptr<CfgStats> JSONConfig::new_stats([[maybe_unused]] uint64_t instance_id, [[maybe_unused]] size_t slot) {
+#ifdef TANU_CFG_STATS
+        return std::make_unique<CfgStats>(instance_id, slot);
+#else
+        return nullptr;
+#endif
+    }
+
+    CfgStatsSnapshot JSONConfig::stats() const {
+        return this->m_stats ? this->m_stats->snapshot() : CfgStatsSnapshot {};
+    }
+
+    JSONConfig::~JSONConfig() {
+        unwatch();
+        this->m_notifier.reset();
+        // other threads drop their entries the next time the slot is reused
+        if(this->m_reader_slot < t_reader_cache.size()) {
+            t_reader_cache[this->m_reader_slot] = ReaderCacheEntry {};
+        }
+        release_reader_slot(this->m_reader_slot);
+    }
+
+    void JSONConfig::publish(std::shared_ptr<const CfgSnapshot> snapshot) {
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+            this->m_current.swap(snapshot);
+            const uint64_t version = this->m_version.fetch_add(1, std::memory_order_acq_rel) + 1;
+            if(this->m_notifier) {
+                this->m_notifier->post(this->m_current, version);
             }
-            if(rez_v.size() == 0) {
-                throw TanuCfgException(std::format("key \'{}\' not found", key_base));
+        }
+        if(this->m_stats) {
+            this->m_stats->record_phase(CfgLoadPhase::Publish, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        }
+        // the previous version, if nobody else holds it, is torn down here
+        // rather than under the lock
+    }
+
+    uint64_t JSONConfig::subscribe(std::string prefix, CfgNotifier::Callback callback) {
+        CfgNotifier* notifier;
+        {
+            std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+            if(!this->m_notifier) {
+                this->m_notifier = std::make_unique<CfgNotifier>(this->m_current, this->m_version.load(std::memory_order_relaxed));
             }
-            return rez_v;
+            notifier = this->m_notifier.get();
+        }
+        return notifier->subscribe(std::move(prefix), std::move(callback));
+    }
 
-        } catch(const json::exception& json_ex) { 
-            throw TanuCfgException(std::format("json::exception -> {}", json_ex.what()));
-        }  catch(const TanuCfgException& ex) {
-            throw;
-        } catch(...) {
-            std::exception_ptr ex_p = std::current_exception();
-            std::rethrow_exception(ex_p);
+    void JSONConfig::unsubscribe(uint64_t id) {
+        CfgNotifier* notifier;
+        {
+            std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+            notifier = this->m_notifier.get();
+        }
+        if(notifier != nullptr) {
+            notifier->unsubscribe(id);
         }
     }
 
-    std::vector<int> JSONConfig::get_as_int_vec(const std::string& key_o) {
-        std::string key_base = key_o;
-        std::string key {};
-        int idx = 0;
-        try {
+    void JSONConfig::flush_notifications() {
+        CfgNotifier* notifier;
+        {
+            std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+            notifier = this->m_notifier.get();
+        }
+        if(notifier != nullptr) {
+            notifier->flush();
+        }
+    }
 
-            if(this->m_loaded_cfg == nullptr || this->m_cfg_flattened_view == nullptr) {
-                throw TanuCfgException("Json config hasn't loaded yet");
-            }
-            if(key_base.front() != '/') key_base.insert(key_base.begin(), '/');
-
-            std::vector<int> rez_v;
-            while(true) {
-                key = std::format("{}/{}", key_base, idx);
-                if(this->m_cfg_flattened_view.get()->contains(key)) {
-                    auto v = this->m_cfg_flattened_view.get()->at(key);
-                    if(!v.is_number_integer()) {
-                        throw TanuCfgException(key_base + "'s value is not integer");
-                    }
-                    rez_v.push_back(v);
-                    idx++;
-                } else {
-                    break;
-                }
+    const std::shared_ptr<const CfgSnapshot>& JSONConfig::current() const {
+        const uint64_t version = this->m_version.load(std::memory_order_acquire);
+        if(this->m_reader_slot < t_reader_cache.size()) [[likely]] {
+            const ReaderCacheEntry& entry = t_reader_cache[this->m_reader_slot];
+            if(entry.instance_id == this->m_instance_id && entry.version == version) [[likely]] {
+                return entry.snapshot;
             }
-            if(rez_v.size() == 0) {
-                throw TanuCfgException(std::format("key \'{}\' not found", key_base));
+        }
+        return refresh(version);
+    }
+
+    const std::shared_ptr<const CfgSnapshot>& JSONConfig::refresh(uint64_t version) const {
+        if(version == 0) {
+            throw TanuCfgException("Json config hasn't loaded yet");
+        }
+        // m_current is at least as new as version here; if it is newer the
+        // entry is simply refreshed once more on the next read
+        if(this->m_reader_slot >= t_reader_cache.size()) {
+            t_reader_cache.resize(this->m_reader_slot + 1);
+        }
+        ReaderCacheEntry& entry = t_reader_cache[this->m_reader_slot];
+        {
+            std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+            entry.snapshot = this->m_current;
+        }
+        entry.instance_id = this->m_instance_id;
+        entry.version = version;
+        return entry.snapshot;
+    }
+
+    std::shared_ptr<const CfgSnapshot> JSONConfig::snapshot() {
+        return current();
+    }
+
+    std::optional<std::string> JSONConfig::dump_cfg() {
+        if(this->version() != 0) {
+            return whole_index(*current()).to_json().dump();
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<std::string> JSONConfig::dump_flattened_view() {
+        if(this->version() != 0) {
+            return whole_index(*current()).to_flattened_json().dump();
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    bool JSONConfig::dump(const CfgSink& sink, const CfgDumpOptions& options) {
+        if(this->version() == 0) {
+            return false;
+        }
+        const CfgSnapshot& snapshot = *current();
+        const CfgIndex* index = &snapshot.index;
+        if(snapshot.lazy) {
+            index = options.prefix.empty() ? nullptr : &lazy_index_for(snapshot, options.prefix);
+            // prefixes above the sections, like a whole top-level object,
+            // need the whole document
+            if(index == nullptr || index->find(options.prefix) == nullptr) {
+                index = &whole_index(snapshot);
             }
-            return rez_v;
+        }
+        return index->dump(sink, options);
+    }
 
-        } catch(const json::exception& json_ex) { 
-            throw TanuCfgException(std::format("json::exception -> {}", json_ex.what()));
-        }  catch(const TanuCfgException& ex) {
-            throw;
-        } catch(...) {
-            std::exception_ptr ex_p = std::current_exception();
-            std::rethrow_exception(ex_p);
+    bool JSONConfig::dump(std::ostream& out, const CfgDumpOptions& options) {
+        return dump(cfg_ostream_sink(out), options);
+    }
+
+    bool JSONConfig::dump(int fd, const CfgDumpOptions& options) {
+        return dump(cfg_fd_sink(fd), options);
+    }
+
+    CfgMemoryUsage JSONConfig::memory_usage() {
+        if(this->version() != 0) {
+            const CfgSnapshot& snapshot = *current();
+            return snapshot.lazy ? snapshot.lazy->memory_usage() : snapshot.index.memory_usage();
+        } else {
+            return CfgMemoryUsage {};
         }
     }
 
-    std::vector<std::string> JSONConfig::get_as_str_vec(const std::string& key_o) {
-        std::string key_base = key_o;
-        std::string key {};
-        int idx = 0;
-        try {
+    const CfgValue* JSONConfig::find_leaf(const CfgIndex& index, std::string_view key, uint64_t hash) noexcept {
+        const CfgValue* v = index.find(key, hash);
+        // only leaves were visible through the flattened view
+        if(v == nullptr || (v->type == CfgType::Object && v->range.count > 0)
+                || (v->type == CfgType::Array && v->range.count > 0)) {
+            return nullptr;
+        }
+        return v;
+    }
+
+    const CfgValue* JSONConfig::find_array(const CfgIndex& index, std::string_view key, uint64_t hash) noexcept {
+        const CfgValue* arr = index.find(key, hash);
+        if(arr == nullptr || arr->type != CfgType::Array || arr->range.count == 0) {
+            return nullptr;
+        }
+        return arr;
+    }
+
+    const CfgValue& JSONConfig::lookup(const CfgIndex& index, std::string_view key, uint64_t hash) {
+        const CfgValue* v = find_leaf(index, key, hash);
+        if(v == nullptr) {
+            throw_key_not_found(key);
+        }
+        return *v;
+    }
+
+    const CfgValue& JSONConfig::lookup_array(const CfgIndex& index, std::string_view key, uint64_t hash) {
+        const CfgValue* arr = find_array(index, key, hash);
+        if(arr == nullptr) {
+            throw_vec_key_not_found(key);
+        }
+        return *arr;
+    }
+
+    bool JSONConfig::has_value(const CfgIndex& index, std::string_view key, uint64_t hash) {
+        const CfgValue* v = index.find(key, hash);
+        return v != nullptr && v->type != CfgType::Null;
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, int& out) {
+        int64_t wide;
+        read_value(index, key, hash, wide);
+        if(!fits_int(wide)) {
+            throw TanuCfgException(normalized_key(key) + "'s value is out of int range");
+        }
+        out = static_cast<int>(wide);
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, int64_t& out) {
+        const CfgValue& v = lookup(index, key, hash);
+        if(!is_integer(v)) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not integer");
+        }
+        if(v.type == CfgType::UInt) {
+            throw TanuCfgException(normalized_key(key) + "'s value is out of int64 range");
+        }
+        out = v.i;
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, uint64_t& out) {
+        const CfgValue& v = lookup(index, key, hash);
+        if(!is_integer(v)) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not integer");
+        }
+        if(v.type == CfgType::Int && v.i < 0) {
+            throw TanuCfgException(normalized_key(key) + "'s value is out of uint64 range");
+        }
+        out = v.type == CfgType::UInt ? v.u : static_cast<uint64_t>(v.i);
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, double& out) {
+        const CfgValue& v = lookup(index, key, hash);
+        if(v.type != CfgType::Double) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not double");
+        }
+        out = v.d;
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, bool& out) {
+        const CfgValue& v = lookup(index, key, hash);
+        if(v.type != CfgType::Bool) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not boolean");
+        }
+        out = v.b;
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::string& out) {
+        std::string_view view;
+        read_value(index, key, hash, view);
+        out.assign(view);
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::string_view& out) {
+        const CfgValue& v = lookup(index, key, hash);
+        if(v.type != CfgType::String) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not string");
+        }
+        out = index.str(v);
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<int>& out) {
+        const std::span<const int64_t> v = index.int_array(lookup_array(index, key, hash));
+        if(v.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not integer");
+        }
+        if(!std::all_of(v.begin(), v.end(), fits_int)) {
+            throw TanuCfgException(normalized_key(key) + "'s value is out of int range");
+        }
+        out.resize(v.size());
+        std::transform(v.begin(), v.end(), out.begin(), [](int64_t e) { return static_cast<int>(e); });
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<int64_t>& out) {
+        const std::span<const int64_t> v = index.int_array(lookup_array(index, key, hash));
+        if(v.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not integer");
+        }
+        out.assign(v.begin(), v.end());
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<double>& out) {
+        const std::span<const double> v = index.double_array(lookup_array(index, key, hash));
+        if(v.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not double");
+        }
+        out.assign(v.begin(), v.end());
+    }
+
+    void JSONConfig::read_value(const CfgIndex& index, std::string_view key, uint64_t hash, std::vector<std::string>& out) {
+        const std::span<const std::string_view> v = index.str_array(lookup_array(index, key, hash));
+        if(v.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not string");
+        }
+        out.assign(v.begin(), v.end());
+    }
+
+    int JSONConfig::get_as_int(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Int, key);
+        int rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    std::string JSONConfig::get_as_str(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Str, key);
+        std::string rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
 
-            if(this->m_loaded_cfg == nullptr || this->m_cfg_flattened_view == nullptr) {
-                throw TanuCfgException("Json config hasn't loaded yet");
-            }
-
-            if(key_base.front() != '/') key_base.insert(key_base.begin(), '/');
-            std::vector<std::string> rez_v;
-            while(true) {
-                key = std::format("{}/{}", key_base, idx);
-                if(this->m_cfg_flattened_view.get()->contains(key)) {
-                    auto v = this->m_cfg_flattened_view.get()->at(key);
-                    if(!v.is_string()) {
-                        throw TanuCfgException(key_base + "'s value is not string");
-                    }
-                    rez_v.push_back(v);
-                    idx++;
-                } else {
-                    break;
+    double JSONConfig::get_as_double(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Double, key);
+        double rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    std::string CfgError::message() const {
+        switch(this->code) {
+            case CfgErrc::NotLoaded:
+                return "Json config hasn't loaded yet";
+            case CfgErrc::NotFound:
+                return std::format("key '{}' not found", normalized_key(this->key));
+            case CfgErrc::Malformed:
+                return "Json file loading/parsing failed";
+            case CfgErrc::OutOfRange:
+                return std::format("{}'s value is out of {} range", normalized_key(this->key), this->expected);
+            default:
+                return std::format("{}'s value is not {}", normalized_key(this->key), this->expected);
+        }
+    }
+
+    template<CfgType Type, typename T, typename Extract>
+    std::expected<T, CfgError> JSONConfig::try_read(CfgHashedKey hashed, const char* expected, Extract extract) {
+        const std::string_view key = hashed.path();
+        if(this->version() == 0) {
+            return std::unexpected(CfgError {CfgErrc::NotLoaded, key, expected});
+        }
+        const CfgIndex* index = try_index_for(*current(), key);
+        if(index == nullptr) {
+            return std::unexpected(CfgError {CfgErrc::Malformed, key, expected});
+        }
+        if constexpr (Type == CfgType::Array) {
+            const CfgValue* arr = find_array(*index, key, hashed.hash());
+            if(arr == nullptr) {
+                return std::unexpected(CfgError {CfgErrc::NotFound, key, expected});
+            }
+            // the typed pools are empty for arrays of other elements
+            const T rez = extract(*index, *arr);
+            if(rez.empty()) {
+                return std::unexpected(CfgError {CfgErrc::TypeMismatch, key, expected});
+            }
+            return rez;
+        } else {
+            const CfgValue* v = find_leaf(*index, key, hashed.hash());
+            if(v == nullptr) {
+                return std::unexpected(CfgError {CfgErrc::NotFound, key, expected});
+            }
+            if(Type == CfgType::Int ? !is_integer(*v) : v->type != Type) {
+                return std::unexpected(CfgError {CfgErrc::TypeMismatch, key, expected});
+            }
+            if constexpr (std::is_same_v<T, int>) {
+                if(v->type == CfgType::UInt || !fits_int(v->i)) {
+                    return std::unexpected(CfgError {CfgErrc::OutOfRange, key, "int"});
                 }
             }
-            if(rez_v.size() == 0) {
-                throw TanuCfgException(std::format("key \'{}\' not found", key_base));
+            return extract(*index, *v);
+        }
+    }
+
+    std::expected<int, CfgError> JSONConfig::try_get_as_int(CfgHashedKey hashed) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, TryInt, hashed.path());
+        auto rez = try_read<CfgType::Int, int>(hashed, "integer", [](const CfgIndex&, const CfgValue& v) {
+            return static_cast<int>(v.i);
+        });
+        if(!rez) {
+            TANU_CFG_STATS_MISS();
+        }
+        return rez;
+    }
+
+    std::expected<double, CfgError> JSONConfig::try_get_as_double(CfgHashedKey hashed) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, TryDouble, hashed.path());
+        auto rez = try_read<CfgType::Double, double>(hashed, "double", [](const CfgIndex&, const CfgValue& v) {
+            return v.d;
+        });
+        if(!rez) {
+            TANU_CFG_STATS_MISS();
+        }
+        return rez;
+    }
+
+    std::expected<std::string_view, CfgError> JSONConfig::try_get_as_str(CfgHashedKey hashed) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, TryStr, hashed.path());
+        auto rez = try_read<CfgType::String, std::string_view>(hashed, "string", [](const CfgIndex& index, const CfgValue& v) {
+            return index.str(v);
+        });
+        if(!rez) {
+            TANU_CFG_STATS_MISS();
+        }
+        return rez;
+    }
+
+    std::expected<std::span<const int64_t>, CfgError> JSONConfig::try_get_as_int_span(CfgHashedKey hashed) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, TryIntSpan, hashed.path());
+        auto rez = try_read<CfgType::Array, std::span<const int64_t>>(hashed, "integer", [](const CfgIndex& index, const CfgValue& arr) {
+            return index.int_array(arr);
+        });
+        if(!rez) {
+            TANU_CFG_STATS_MISS();
+        }
+        return rez;
+    }
+
+    std::expected<std::span<const double>, CfgError> JSONConfig::try_get_as_double_span(CfgHashedKey hashed) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, TryDoubleSpan, hashed.path());
+        auto rez = try_read<CfgType::Array, std::span<const double>>(hashed, "double", [](const CfgIndex& index, const CfgValue& arr) {
+            return index.double_array(arr);
+        });
+        if(!rez) {
+            TANU_CFG_STATS_MISS();
+        }
+        return rez;
+    }
+
+    std::expected<std::span<const std::string_view>, CfgError> JSONConfig::try_get_as_str_span(CfgHashedKey hashed) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, TryStrSpan, hashed.path());
+        auto rez = try_read<CfgType::Array, std::span<const std::string_view>>(hashed, "string", [](const CfgIndex& index, const CfgValue& arr) {
+            return index.str_array(arr);
+        });
+        if(!rez) {
+            TANU_CFG_STATS_MISS();
+        }
+        return rez;
+    }
+
+    int JSONConfig::get_or(std::string_view key, int default_value) {
+        return try_get_as_int(key).value_or(default_value);
+    }
+
+    double JSONConfig::get_or(std::string_view key, double default_value) {
+        return try_get_as_double(key).value_or(default_value);
+    }
+
+    std::string_view JSONConfig::get_or(std::string_view key, std::string_view default_value) {
+        return try_get_as_str(key).value_or(default_value);
+    }
+
+    template<typename T>
+    CfgKey<T> JSONConfig::resolve(std::string_view key) {
+        const std::shared_ptr<const CfgSnapshot>& snapshot = current();
+        const CfgIndex& index = index_for(*snapshot, key);
+        const CfgValue& v = lookup(index, key, cfg_key_hash(key));
+        if constexpr (std::is_same_v<T, int>) {
+            if(!is_integer(v)) {
+                throw TanuCfgException(normalized_key(key) + "'s value is not integer");
+            }
+            if(v.type == CfgType::UInt || !fits_int(v.i)) {
+                throw TanuCfgException(normalized_key(key) + "'s value is out of int range");
+            }
+        } else if constexpr (std::is_same_v<T, double>) {
+            if(v.type != CfgType::Double) {
+                throw TanuCfgException(normalized_key(key) + "'s value is not double");
+            }
+        } else {
+            if(v.type != CfgType::String) {
+                throw TanuCfgException(normalized_key(key) + "'s value is not string");
             }
-            return rez_v;
+        }
+        // the handle shares ownership of the whole snapshot it points into
+        return CfgKey<T>(std::shared_ptr<const CfgIndex>(snapshot, &index), &v);
+    }
 
-        } catch(const json::exception& json_ex) { 
-            throw TanuCfgException(std::format("json::exception -> {}", json_ex.what()));
-        } catch(const TanuCfgException& ex) {
-            throw;
-        } catch(...) {
-            std::exception_ptr ex_p = std::current_exception();
-            std::rethrow_exception(ex_p);
+    template CfgKey<int> JSONConfig::resolve<int>(std::string_view key);
+    template CfgKey<double> JSONConfig::resolve<double>(std::string_view key);
+    template CfgKey<std::string> JSONConfig::resolve<std::string>(std::string_view key);
+
+    std::span<const int64_t> JSONConfig::get_as_int_span(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, IntSpan, key);
+        const CfgIndex& index = index_for(*current(), key);
+        const std::span<const int64_t> rez = index.int_array(lookup_array(index, key, hashed.hash()));
+        if(rez.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not integer");
+        }
+        return rez;
+    }
+
+    std::span<const double> JSONConfig::get_as_double_span(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, DoubleSpan, key);
+        const CfgIndex& index = index_for(*current(), key);
+        const std::span<const double> rez = index.double_array(lookup_array(index, key, hashed.hash()));
+        if(rez.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not double");
+        }
+        return rez;
+    }
+
+    std::span<const std::string_view> JSONConfig::get_as_str_span(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, StrSpan, key);
+        const CfgIndex& index = index_for(*current(), key);
+        const std::span<const std::string_view> rez = index.str_array(lookup_array(index, key, hashed.hash()));
+        if(rez.empty()) {
+            throw TanuCfgException(normalized_key(key) + "'s value is not string");
+        }
+        return rez;
+    }
+
+    int64_t JSONConfig::get_as_int64(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Int64, key);
+        int64_t rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    uint64_t JSONConfig::get_as_uint64(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, UInt64, key);
+        uint64_t rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    float JSONConfig::get_as_float(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Float, key);
+        double rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return static_cast<float>(rez);
+    }
+
+    bool JSONConfig::get_as_bool(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Bool, key);
+        bool rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    std::pair<std::span<const int64_t>, std::span<const double>> JSONConfig::numeric_array(const CfgIndex& index, std::string_view key, bool integral) {
+        const CfgValue& arr = lookup_array(index, key, cfg_key_hash(key));
+        const std::span<const int64_t> ints = index.int_array(arr);
+        const std::span<const double> doubles = integral ? std::span<const double> {} : index.double_array(arr);
+        if(ints.empty() && doubles.empty()) {
+            throw TanuCfgException(normalized_key(key) + (integral ? "'s value is not integer" : "'s value is not numeric"));
+        }
+        return {ints, doubles};
+    }
+
+    namespace {
+        template<typename T>
+        void export_numbers(std::span<const int64_t> ints, std::span<const double> doubles, T* out) {
+            if constexpr (std::is_same_v<T, int64_t>) {
+                std::copy(ints.begin(), ints.end(), out);
+            } else if(!ints.empty()) {
+                cfg_convert(ints, out);
+            } else if constexpr (std::is_same_v<T, double>) {
+                std::copy(doubles.begin(), doubles.end(), out);
+            } else {
+                cfg_convert(doubles, out);
+            }
+        }
+    }
+
+    template<typename T>
+    size_t JSONConfig::copy_as(std::string_view key, std::span<T> out) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, CopyAs, key);
+        const auto [ints, doubles] = numeric_array(index_for(*current(), key), key, std::is_integral_v<T>);
+        const size_t n = ints.size() + doubles.size();
+        if(out.size() < n) {
+            throw TanuCfgException(std::format("{} has {} values, more than the {} that fit", normalized_key(key), n, out.size()));
+        }
+        export_numbers(ints, doubles, out.data());
+        return n;
+    }
+
+    template<typename T>
+    CfgAlignedArray<T> JSONConfig::copy_as_aligned(std::string_view key, size_t alignment) {
+        TANU_CFG_STATS_SCOPE(this->m_stats, CopyAs, key);
+        const auto [ints, doubles] = numeric_array(index_for(*current(), key), key, std::is_integral_v<T>);
+        CfgAlignedArray<T> rez(ints.size() + doubles.size(), std::max(alignment, alignof(T)));
+        export_numbers(ints, doubles, rez.data());
+        return rez;
+    }
+
+    template size_t JSONConfig::copy_as<float>(std::string_view key, std::span<float> out);
+    template size_t JSONConfig::copy_as<double>(std::string_view key, std::span<double> out);
+    template size_t JSONConfig::copy_as<int64_t>(std::string_view key, std::span<int64_t> out);
+    template CfgAlignedArray<float> JSONConfig::copy_as_aligned<float>(std::string_view key, size_t alignment);
+    template CfgAlignedArray<double> JSONConfig::copy_as_aligned<double>(std::string_view key, size_t alignment);
+    template CfgAlignedArray<int64_t> JSONConfig::copy_as_aligned<int64_t>(std::string_view key, size_t alignment);
+
+    std::string_view JSONConfig::get_as_str_view(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, StrView, key);
+        std::string_view rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    template<typename T>
+    T JSONConfig::get_unchecked(CfgHashedKey hashed) noexcept {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, Unchecked, key);
+        const CfgSnapshot& snapshot = *current();
+        // validation already parsed lazy sections whole
+        const CfgIndex& index = snapshot.lazy ? snapshot.whole() : snapshot.index;
+        const CfgValue* v = index.find(key, hashed.hash());
+        if constexpr (std::is_same_v<T, int64_t>) {
+            // "integer" also admits values above INT64_MAX
+            return v->type == CfgType::UInt ? std::numeric_limits<int64_t>::max() : v->i;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return v->type == CfgType::Double ? v->d : v->type == CfgType::Int ? static_cast<double>(v->i) : static_cast<double>(v->u);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return v->b;
+        } else {
+            static_assert(std::is_same_v<T, std::string_view>, "get_unchecked reads int64_t, double, bool or std::string_view");
+            return index.str(*v);
         }
     }
+
+    template int64_t JSONConfig::get_unchecked<int64_t>(CfgHashedKey key) noexcept;
+    template double JSONConfig::get_unchecked<double>(CfgHashedKey key) noexcept;
+    template bool JSONConfig::get_unchecked<bool>(CfgHashedKey key) noexcept;
+    template std::string_view JSONConfig::get_unchecked<std::string_view>(CfgHashedKey key) noexcept;
+
+    CfgKeyRange JSONConfig::keys_with_prefix(std::string_view prefix) {
+        return CfgKeyRange(whole_index(*current()).with_prefix(prefix), CfgEntryKey {});
+    }
+
+    CfgPathRange JSONConfig::subtree(std::string_view key) {
+        return whole_index(*current()).subtree(key);
+    }
+
+    size_t JSONConfig::array_size(std::string_view key) {
+        const CfgValue* arr = index_for(*current(), key).find(key, cfg_key_hash(key));
+        if(arr == nullptr || arr->type != CfgType::Array) {
+            throw_vec_key_not_found(key);
+        }
+        return arr->range.count;
+    }
+
+    std::vector<double> JSONConfig::get_as_double_vec(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, DoubleVec, key);
+        std::vector<double> rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    std::vector<int> JSONConfig::get_as_int_vec(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, IntVec, key);
+        std::vector<int> rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    std::vector<std::string> JSONConfig::get_as_str_vec(CfgHashedKey hashed) {
+        const std::string_view key = hashed.path();
+        TANU_CFG_STATS_SCOPE(this->m_stats, StrVec, key);
+        std::vector<std::string> rez;
+        read_value(index_for(*current(), key), key, hashed.hash(), rez);
+        return rez;
+    }
+
+    // plain keys are hashed here and take the hashed-key path
+
+    int JSONConfig::get_as_int(std::string_view key) {
+        return get_as_int(CfgHashedKey(key));
+    }
+
+    std::string JSONConfig::get_as_str(std::string_view key) {
+        return get_as_str(CfgHashedKey(key));
+    }
+
+    double JSONConfig::get_as_double(std::string_view key) {
+        return get_as_double(CfgHashedKey(key));
+    }
+
+    std::expected<int, CfgError> JSONConfig::try_get_as_int(std::string_view key) {
+        return try_get_as_int(CfgHashedKey(key));
+    }
+
+    std::expected<double, CfgError> JSONConfig::try_get_as_double(std::string_view key) {
+        return try_get_as_double(CfgHashedKey(key));
+    }
+
+    std::expected<std::string_view, CfgError> JSONConfig::try_get_as_str(std::string_view key) {
+        return try_get_as_str(CfgHashedKey(key));
+    }
+
+    std::expected<std::span<const int64_t>, CfgError> JSONConfig::try_get_as_int_span(std::string_view key) {
+        return try_get_as_int_span(CfgHashedKey(key));
+    }
+
+    std::expected<std::span<const double>, CfgError> JSONConfig::try_get_as_double_span(std::string_view key) {
+        return try_get_as_double_span(CfgHashedKey(key));
+    }
+
+    std::expected<std::span<const std::string_view>, CfgError> JSONConfig::try_get_as_str_span(std::string_view key) {
+        return try_get_as_str_span(CfgHashedKey(key));
+    }
+
+    std::span<const int64_t> JSONConfig::get_as_int_span(std::string_view key) {
+        return get_as_int_span(CfgHashedKey(key));
+    }
+
+    std::span<const double> JSONConfig::get_as_double_span(std::string_view key) {
+        return get_as_double_span(CfgHashedKey(key));
+    }
+
+    std::span<const std::string_view> JSONConfig::get_as_str_span(std::string_view key) {
+        return get_as_str_span(CfgHashedKey(key));
+    }
+
+    int64_t JSONConfig::get_as_int64(std::string_view key) {
+        return get_as_int64(CfgHashedKey(key));
+    }
+
+    uint64_t JSONConfig::get_as_uint64(std::string_view key) {
+        return get_as_uint64(CfgHashedKey(key));
+    }
+
+    float JSONConfig::get_as_float(std::string_view key) {
+        return get_as_float(CfgHashedKey(key));
+    }
+
+    bool JSONConfig::get_as_bool(std::string_view key) {
+        return get_as_bool(CfgHashedKey(key));
+    }
+
+    std::string_view JSONConfig::get_as_str_view(std::string_view key) {
+        return get_as_str_view(CfgHashedKey(key));
+    }
+
+    std::vector<double> JSONConfig::get_as_double_vec(std::string_view key) {
+        return get_as_double_vec(CfgHashedKey(key));
+    }
+
+    std::vector<int> JSONConfig::get_as_int_vec(std::string_view key) {
+        return get_as_int_vec(CfgHashedKey(key));
+    }
+
+    std::vector<std::string> JSONConfig::get_as_str_vec(std::string_view key) {
+        return get_as_str_vec(CfgHashedKey(key));
+    }
+
+    template<typename T>
+    T JSONConfig::get_unchecked(std::string_view key) noexcept {
+        return get_unchecked<T>(CfgHashedKey(key));
+    }
+
+    template int64_t JSONConfig::get_unchecked<int64_t>(std::string_view key) noexcept;
+    template double JSONConfig::get_unchecked<double>(std::string_view key) noexcept;
+    template bool JSONConfig::get_unchecked<bool>(std::string_view key) noexcept;
+    template std::string_view JSONConfig::get_unchecked<std::string_view>(std::string_view key) noexcept;
+
+    // std::string and literal keys forward to the string_view getters
+
+    int JSONConfig::get_as_int(const std::string& key) {
+        return get_as_int(std::string_view {key});
+    }
+
+    int JSONConfig::get_as_int(const char* key) {
+        return get_as_int(std::string_view {key});
+    }
+
+    std::string JSONConfig::get_as_str(const std::string& key) {
+        return get_as_str(std::string_view {key});
+    }
+
+    std::string JSONConfig::get_as_str(const char* key) {
+        return get_as_str(std::string_view {key});
+    }
+
+    double JSONConfig::get_as_double(const std::string& key) {
+        return get_as_double(std::string_view {key});
+    }
+
+    double JSONConfig::get_as_double(const char* key) {
+        return get_as_double(std::string_view {key});
+    }
+
+    std::vector<int> JSONConfig::get_as_int_vec(const std::string& key) {
+        return get_as_int_vec(std::string_view {key});
+    }
+
+    std::vector<int> JSONConfig::get_as_int_vec(const char* key) {
+        return get_as_int_vec(std::string_view {key});
+    }
+
+    std::vector<std::string> JSONConfig::get_as_str_vec(const std::string& key) {
+        return get_as_str_vec(std::string_view {key});
+    }
+
+    std::vector<std::string> JSONConfig::get_as_str_vec(const char* key) {
+        return get_as_str_vec(std::string_view {key});
+    }
+
+    std::vector<double> JSONConfig::get_as_double_vec(const std::string& key) {
+        return get_as_double_vec(std::string_view {key});
+    }
+
+    std::vector<double> JSONConfig::get_as_double_vec(const char* key) {
+        return get_as_double_vec(std::string_view {key});
+    }
 }
@@ -0,0 +1,98 @@
+#include "cpptanu_cfg/cfg_registry.h"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#ifdef __unix__
+#include <sys/stat.h>
+#endif
+
+namespace tanu::cfg {
+
+    CfgFileId CfgFileId::of(const std::filesystem::path& fpath) {
+#ifdef __unix__
+        struct stat st;
+        if(stat(fpath.c_str(), &st) != 0) {
+            throw std::runtime_error(std::format("stat {} failed: {}", fpath.string(), std::strerror(errno)));
+        }
+        return CfgFileId {
+            static_cast<uint64_t>(st.st_dev),
+            static_cast<uint64_t>(st.st_ino),
+            static_cast<uint64_t>(st.st_size),
+            static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec
+        };
+#else
+        return CfgFileId {
+            0,
+            0,
+            static_cast<uint64_t>(std::filesystem::file_size(fpath)),
+            static_cast<int64_t>(std::filesystem::last_write_time(fpath).time_since_epoch().count())
+        };
+#endif
+    }
+
+    CfgRegistry& CfgRegistry::instance() {
+        static CfgRegistry registry;
+        return registry;
+    }
+
+    std::shared_ptr<const CfgSnapshot> CfgRegistry::acquire(const std::filesystem::path& fpath, CfgLoadMode mode, const Loader& load) {
+        const std::filesystem::path canonical = std::filesystem::canonical(fpath);
+        const CfgFileId id = CfgFileId::of(canonical);
+
+        std::promise<std::shared_ptr<const CfgSnapshot>> promise;
+        Entry* entry;
+        uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            entry = &m_entries[{canonical.string(), mode}];
+            if(entry->id == id) {
+                if(std::shared_ptr<const CfgSnapshot> live = entry->snapshot.lock()) {
+                    return live;
+                }
+                if(entry->pending.valid()) {
+                    const Pending pending = entry->pending;
+                    lock.unlock();
+                    return pending.get();
+                }
+            }
+            // first request for this identity: load it here, the others wait
+            entry->id = id;
+            entry->snapshot.reset();
+            entry->pending = promise.get_future().share();
+            generation = ++entry->generation;
+        }
+
+        m_loads.fetch_add(1, std::memory_order_relaxed);
+        std::shared_ptr<const CfgSnapshot> snapshot;
+        try {
+            snapshot = load();
+        } catch(...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if(entry->generation == generation) {
+                entry->pending = Pending();
+            }
+            throw;
+        }
+        promise.set_value(snapshot);
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if(entry->generation == generation) {
+            entry->snapshot = snapshot;
+            entry->pending = Pending();
+        }
+        return snapshot;
+    }
+
+    size_t CfgRegistry::live_count() const {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        size_t n = 0;
+        for(const auto& [key, entry] : m_entries) {
+            n += entry.pending.valid() || !entry.snapshot.expired() ? 1 : 0;
+        }
+        return n;
+    }
+
+}
@@ -0,0 +1,320 @@
+#include "cpptanu_cfg/cfg_schema.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace tanu::cfg {
+
+    namespace {
+        uint8_t type_bit(std::string_view name) {
+            if(name == "null") {
+                return SchemaNull;
+            }
+            if(name == "boolean") {
+                return SchemaBoolean;
+            }
+            if(name == "integer") {
+                return SchemaInteger;
+            }
+            if(name == "number") {
+                return SchemaInteger | SchemaDouble;
+            }
+            if(name == "string") {
+                return SchemaString;
+            }
+            if(name == "array") {
+                return SchemaArray;
+            }
+            if(name == "object") {
+                return SchemaObject;
+            }
+            throw std::runtime_error(std::format("unknown schema type '{}'", name));
+        }
+
+        uint8_t type_bit(CfgType type) noexcept {
+            switch(type) {
+                case CfgType::Null:
+                    return SchemaNull;
+                case CfgType::Bool:
+                    return SchemaBoolean;
+                case CfgType::Int:
+                case CfgType::UInt:
+                    return SchemaInteger;
+                case CfgType::Double:
+                    return SchemaDouble;
+                case CfgType::String:
+                    return SchemaString;
+                case CfgType::Array:
+                    return SchemaArray;
+                default:
+                    return SchemaObject;
+            }
+        }
+
+        std::string_view type_name(CfgType type) noexcept {
+            switch(type) {
+                case CfgType::Null:
+                    return "null";
+                case CfgType::Bool:
+                    return "boolean";
+                case CfgType::Int:
+                case CfgType::UInt:
+                    return "integer";
+                case CfgType::Double:
+                    return "number";
+                case CfgType::String:
+                    return "string";
+                case CfgType::Array:
+                    return "array";
+                default:
+                    return "object";
+            }
+        }
+
+        double number_of(const json& schema, const char* keyword) {
+            const json& v = schema.at(keyword);
+            if(!v.is_number()) {
+                throw std::runtime_error(std::format("schema keyword '{}' must be a number", keyword));
+            }
+            return v.get<double>();
+        }
+
+        uint64_t count_of(const json& schema, const char* keyword) {
+            const json& v = schema.at(keyword);
+            if(!v.is_number_unsigned() && !(v.is_number_integer() && v.get<int64_t>() >= 0)) {
+                throw std::runtime_error(std::format("schema keyword '{}' must be a non-negative integer", keyword));
+            }
+            return v.get<uint64_t>();
+        }
+
+        double as_double(const CfgValue& v) noexcept {
+            switch(v.type) {
+                case CfgType::Int:
+                    return static_cast<double>(v.i);
+                case CfgType::UInt:
+                    return static_cast<double>(v.u);
+                default:
+                    return v.d;
+            }
+        }
+
+        std::string_view shown(std::string_view path) noexcept {
+            return path.empty() ? "/" : path;
+        }
+    }
+
+    CfgSchema CfgSchema::compile(const json& schema) {
+        CfgSchema rez;
+        rez.compile_rule(schema, "", true, true, true);
+        return rez;
+    }
+
+    uint32_t CfgSchema::compile_rule(const json& schema, std::string key, bool absolute, bool required, bool guaranteed) {
+        if(!schema.is_object()) {
+            throw std::runtime_error(std::format("schema for '{}' must be an object", shown(key)));
+        }
+        const uint32_t r = static_cast<uint32_t>(this->m_rules.size());
+        Rule rule {};
+        rule.hash = absolute ? cfg_key_hash(key) : 0;
+        rule.key = std::move(key);
+        rule.absolute = absolute;
+        rule.required = required;
+        rule.types = SchemaAny;
+        rule.minimum = -std::numeric_limits<double>::infinity();
+        rule.maximum = std::numeric_limits<double>::infinity();
+        rule.max_items = UINT64_MAX;
+        rule.items = npos;
+
+        if(const auto it = schema.find("type"); it != schema.end()) {
+            if(it->is_string()) {
+                rule.types = type_bit(it->get_ref<const std::string&>());
+            } else if(it->is_array() && !it->empty()) {
+                rule.types = 0;
+                for(const json& t : *it) {
+                    if(!t.is_string()) {
+                        throw std::runtime_error("schema keyword 'type' must list type names");
+                    }
+                    rule.types |= type_bit(t.get_ref<const std::string&>());
+                }
+            } else {
+                throw std::runtime_error("schema keyword 'type' must be a type name or a list of them");
+            }
+        }
+        if(schema.contains("minimum")) {
+            rule.minimum = number_of(schema, "minimum");
+        }
+        if(schema.contains("maximum")) {
+            rule.maximum = number_of(schema, "maximum");
+        }
+        // with both an inclusive and an exclusive bound on one side, only the
+        // stricter of the two can ever reject anything
+        if(schema.contains("exclusiveMinimum")) {
+            const double bound = number_of(schema, "exclusiveMinimum");
+            if(bound >= rule.minimum) {
+                rule.minimum = bound;
+                rule.exclusive_min = true;
+            }
+        }
+        if(schema.contains("exclusiveMaximum")) {
+            const double bound = number_of(schema, "exclusiveMaximum");
+            if(bound <= rule.maximum) {
+                rule.maximum = bound;
+                rule.exclusive_max = true;
+            }
+        }
+        if(schema.contains("minItems")) {
+            rule.min_items = count_of(schema, "minItems");
+        }
+        if(schema.contains("maxItems")) {
+            rule.max_items = count_of(schema, "maxItems");
+        }
+        const std::string full = rule.key;
+        this->m_rules.push_back(std::move(rule));
+        if(absolute && guaranteed) {
+            this->m_guaranteed.emplace(full, this->m_rules[r].types);
+        }
+
+        std::vector<std::string_view> required_names;
+        if(const auto it = schema.find("required"); it != schema.end()) {
+            if(!it->is_array()) {
+                throw std::runtime_error("schema keyword 'required' must be a list of names");
+            }
+            for(const json& name : *it) {
+                if(!name.is_string()) {
+                    throw std::runtime_error("schema keyword 'required' must be a list of names");
+                }
+                required_names.push_back(name.get_ref<const std::string&>());
+            }
+        }
+        const json empty = json::object();
+        const json* properties = &empty;
+        if(const auto it = schema.find("properties"); it != schema.end()) {
+            if(!it->is_object()) {
+                throw std::runtime_error(std::format("schema properties of '{}' must be an object", shown(full)));
+            }
+            properties = &*it;
+        }
+        // children compile first so their own children stay out of this range
+        const bool object_only = this->m_rules[r].types == SchemaObject;
+        std::vector<uint32_t> children;
+        const auto add_child = [&](const std::string& name, const json& sub, bool req) {
+            const std::string segment = '/' + cfg_pointer_segment(name);
+            children.push_back(this->compile_rule(sub, absolute ? full + segment : segment, absolute, req,
+                guaranteed && req && object_only));
+        };
+        for(const auto& [name, sub] : properties->items()) {
+            add_child(name, sub, std::ranges::find(required_names, name) != required_names.end());
+        }
+        for(const std::string_view name : required_names) {
+            if(!properties->contains(name)) {
+                add_child(std::string {name}, empty, true);
+            }
+        }
+        this->m_rules[r].children_begin = static_cast<uint32_t>(this->m_children.size());
+        this->m_children.insert(this->m_children.end(), children.begin(), children.end());
+        this->m_rules[r].children_end = static_cast<uint32_t>(this->m_children.size());
+        if(const auto it = schema.find("items"); it != schema.end()) {
+            const uint32_t items = this->compile_rule(*it, "", false, true, false);
+            this->m_rules[r].items = items;
+        }
+        return r;
+    }
+
+    std::vector<std::string> CfgSchema::validate(const CfgIndex& index, size_t max_errors) const {
+        Errors errors {{}, max_errors};
+        if(!this->m_rules.empty() && max_errors > 0) {
+            this->check(index, 0, index.root(), "", errors);
+        }
+        return std::move(errors.list);
+    }
+
+    void CfgSchema::check(const CfgIndex& index, uint32_t r, const CfgValue& v, const std::string& path, Errors& errors) const {
+        const Rule& rule = this->m_rules[r];
+        if((rule.types & type_bit(v.type)) == 0) {
+            errors.list.push_back(std::format("{}: unexpected {}", shown(path), type_name(v.type)));
+            return;
+        }
+        if(v.type == CfgType::Int || v.type == CfgType::UInt || v.type == CfgType::Double) {
+            const double d = as_double(v);
+            if(d < rule.minimum || (rule.exclusive_min && d == rule.minimum)) {
+                errors.list.push_back(std::format("{}: {} is below the minimum {}", shown(path), d, rule.minimum));
+            } else if(d > rule.maximum || (rule.exclusive_max && d == rule.maximum)) {
+                errors.list.push_back(std::format("{}: {} is above the maximum {}", shown(path), d, rule.maximum));
+            }
+            return;
+        }
+        if(v.type == CfgType::Object) {
+            for(uint32_t c = rule.children_begin; c < rule.children_end && !errors.full(); c++) {
+                const Rule& child = this->m_rules[this->m_children[c]];
+                std::string relative;
+                if(!child.absolute) {
+                    relative = path + child.key;
+                }
+                const std::string& key = child.absolute ? child.key : relative;
+                const CfgValue* found = child.absolute ? index.find(key, child.hash) : index.find(key);
+                if(found == nullptr) {
+                    if(child.required) {
+                        errors.list.push_back(std::format("{}: missing required key", key));
+                    }
+                    continue;
+                }
+                this->check(index, this->m_children[c], *found, key, errors);
+            }
+            return;
+        }
+        if(v.type != CfgType::Array) {
+            return;
+        }
+        if(v.range.count < rule.min_items) {
+            errors.list.push_back(std::format("{}: {} items, expected at least {}", shown(path), v.range.count, rule.min_items));
+        } else if(v.range.count > rule.max_items) {
+            errors.list.push_back(std::format("{}: {} items, expected at most {}", shown(path), v.range.count, rule.max_items));
+        }
+        if(rule.items == npos) {
+            return;
+        }
+        const Rule& items = this->m_rules[rule.items];
+        const bool leaf_items = items.children_begin == items.children_end && items.items == npos;
+        const bool bounded = !std::isinf(items.minimum) || !std::isinf(items.maximum);
+        if(leaf_items && (items.types == SchemaAny && !bounded)) {
+            return;
+        }
+        // homogeneous arrays sit in a typed pool: one type check for all
+        // of them, and a plain scan when there are bounds
+        if(leaf_items && v.range.count > 0 && v.pool != npos) {
+            const CfgType type = index.child(v, 0).type;
+            if((items.types & type_bit(type)) != 0) {
+                const auto in_range = [&](double d) {
+                    return d >= items.minimum && d <= items.maximum
+                        && !(items.exclusive_min && d == items.minimum) && !(items.exclusive_max && d == items.maximum);
+                };
+                bool ok = true;
+                if(bounded && type == CfgType::Int) {
+                    ok = std::ranges::all_of(index.int_array(v), [&](int64_t i) { return in_range(static_cast<double>(i)); });
+                } else if(bounded && type == CfgType::Double) {
+                    ok = std::ranges::all_of(index.double_array(v), in_range);
+                }
+                if(ok) {
+                    return;
+                }
+            }
+        }
+        std::string element;
+        for(uint32_t i = 0; i < v.range.count && !errors.full(); i++) {
+            element.assign(path).append(1, '/').append(std::to_string(i));
+            this->check(index, rule.items, index.child(v, i), element, errors);
+        }
+    }
+
+    bool CfgSchema::guarantees(std::string_view key, uint8_t types) const {
+        std::string normalized;
+        if(!key.empty() && !key.starts_with('/')) {
+            normalized.push_back('/');
+        }
+        normalized.append(key);
+        const auto it = this->m_guaranteed.find(normalized);
+        return it != this->m_guaranteed.end() && (it->second & ~types) == 0;
+    }
+
+}
@@ -0,0 +1,205 @@
+#include "cpptanu_cfg/cfg_shm.h"
+#include "cpptanu_cfg/cfg_index.h"
+
+#include <cerrno>
+#include <format>
+#include <system_error>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tanu::cfg {
+
+    namespace {
+        std::string control_name(const std::filesystem::path& source) {
+            const std::string abs_path = std::filesystem::absolute(source).lexically_normal().string();
+            return std::format("/tanucfg.{:016x}", cfg_content_hash(abs_path));
+        }
+
+#ifdef __unix__
+        [[noreturn]] void throw_errno(const std::string& what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // segments are only trusted if this user created them: anyone could
+        // have made one under a predictable name first
+        bool owned(int fd) {
+            struct stat st;
+            return fstat(fd, &st) == 0 && st.st_uid == geteuid();
+        }
+#endif
+    }
+
+#ifdef __unix__
+
+    CfgSharedSegments::CfgSharedSegments(const std::filesystem::path& source):
+        m_name(control_name(source)), m_control_fd(-1), m_control(nullptr) {
+
+        m_control_fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if(m_control_fd < 0) {
+            throw_errno("shm_open " + m_name);
+        }
+        if(!owned(m_control_fd)) {
+            close(m_control_fd);
+            throw std::system_error(EPERM, std::generic_category(), m_name + " belongs to another user");
+        }
+        // every opener sizes it the same way, and new pages read as zero
+        if(ftruncate(m_control_fd, sizeof(Control)) != 0) {
+            const int err = errno;
+            close(m_control_fd);
+            errno = err;
+            throw_errno("ftruncate " + m_name);
+        }
+        void* p = mmap(nullptr, sizeof(Control), PROT_READ | PROT_WRITE, MAP_SHARED, m_control_fd, 0);
+        if(p == MAP_FAILED) {
+            const int err = errno;
+            close(m_control_fd);
+            errno = err;
+            throw_errno("mmap " + m_name);
+        }
+        m_control = static_cast<Control*>(p);
+    }
+
+    CfgSharedSegments::~CfgSharedSegments() {
+        munmap(m_control, sizeof(Control));
+        close(m_control_fd);
+    }
+
+    std::string CfgSharedSegments::segment_name(uint64_t generation) const {
+        return std::format("{}.{}", m_name, generation);
+    }
+
+    uint64_t CfgSharedSegments::generation() const noexcept {
+        return m_control->generation.load(std::memory_order_acquire);
+    }
+
+    std::shared_ptr<const MappedFile> CfgSharedSegments::map(uint64_t generation) const {
+        if(generation == 0) {
+            return nullptr;
+        }
+        const std::string name = segment_name(generation);
+        const int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if(fd < 0) {
+            return nullptr;
+        }
+        if(!owned(fd)) {
+            close(fd);
+            return nullptr;
+        }
+        std::shared_ptr<const MappedFile> mapped;
+        try {
+            mapped = std::make_shared<const MappedFile>(fd, name);
+        } catch(const std::runtime_error&) {
+        }
+        close(fd);
+        return mapped;
+    }
+
+    uint64_t CfgSharedSegments::publish(size_t size, const std::function<void(std::byte*)>& fill) {
+        const uint64_t current = generation();
+        const uint64_t next = current + 1;
+        const std::string name = segment_name(next);
+        // left behind by a publisher that died before switching over
+        shm_unlink(name.c_str());
+        const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if(fd < 0) {
+            throw_errno("shm_open " + name);
+        }
+        void* p = MAP_FAILED;
+        if(ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if(p == MAP_FAILED) {
+            const int err = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            errno = err;
+            throw_errno("sizing " + name);
+        }
+        close(fd);
+        fill(static_cast<std::byte*>(p));
+        munmap(p, size);
+
+        m_control->generation.store(next, std::memory_order_release);
+        if(current != 0) {
+            shm_unlink(segment_name(current).c_str());
+        }
+        return next;
+    }
+
+    void CfgSharedSegments::lock() {
+        while(flock(m_control_fd, LOCK_EX) != 0) {
+            if(errno != EINTR) {
+                throw_errno("flock " + m_name);
+            }
+        }
+    }
+
+    void CfgSharedSegments::unlock() {
+        flock(m_control_fd, LOCK_UN);
+    }
+
+    void CfgSharedSegments::unlink(const std::filesystem::path& source) {
+        const std::string name = control_name(source);
+        const int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if(fd < 0) {
+            return;
+        }
+        struct stat st;
+        if(fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Control)) {
+            void* p = mmap(nullptr, sizeof(Control), PROT_READ, MAP_SHARED, fd, 0);
+            if(p != MAP_FAILED) {
+                const uint64_t generation = static_cast<const Control*>(p)->generation.load(std::memory_order_acquire);
+                munmap(p, sizeof(Control));
+                if(generation != 0) {
+                    shm_unlink(std::format("{}.{}", name, generation).c_str());
+                }
+            }
+        }
+        close(fd);
+        shm_unlink(name.c_str());
+    }
+
+#else
+
+    CfgSharedSegments::CfgSharedSegments(const std::filesystem::path& source):
+        m_name(control_name(source)), m_control_fd(-1), m_control(nullptr) {
+        throw std::system_error(std::make_error_code(std::errc::function_not_supported), "shared memory segments need POSIX");
+    }
+
+    CfgSharedSegments::~CfgSharedSegments() {
+    }
+
+    std::string CfgSharedSegments::segment_name(uint64_t generation) const {
+        return std::format("{}.{}", m_name, generation);
+    }
+
+    uint64_t CfgSharedSegments::generation() const noexcept {
+        return 0;
+    }
+
+    std::shared_ptr<const MappedFile> CfgSharedSegments::map(uint64_t) const {
+        return nullptr;
+    }
+
+    uint64_t CfgSharedSegments::publish(size_t, const std::function<void(std::byte*)>&) {
+        return 0;
+    }
+
+    void CfgSharedSegments::lock() {
+    }
+
+    void CfgSharedSegments::unlock() {
+    }
+
+    void CfgSharedSegments::unlink(const std::filesystem::path&) {
+    }
+
+#endif
+
+}
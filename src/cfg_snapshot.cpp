@@ -0,0 +1,238 @@
+#include "cpptanu_cfg/cfg_snapshot.h"
+#include "cpptanu_cfg/cfg_image.h"
+#include "cpptanu_cfg/cfg_mmap.h"
+#include "cpptanu_cfg/cfg_shm.h"
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+
+namespace tanu::cfg {
+
+    namespace {
+        // decides whether a compiled image still matches its source. the
+        // source is only read when the mtime alone can't tell.
+        class SourceCheck {
+        private:
+            const std::filesystem::path& m_fpath;
+            std::unique_ptr<MappedFile> m_source;
+        public:
+            CfgImageKey key;
+            bool restamp;
+
+            // stat before reading: if the file changes underneath, its image
+            // gets an older stamp than its content and is rehashed next time
+            explicit SourceCheck(const std::filesystem::path& fpath): m_fpath(fpath), key {
+                std::filesystem::absolute(fpath).lexically_normal().string(),
+                static_cast<uint64_t>(std::filesystem::file_size(fpath)),
+                static_cast<int64_t>(std::filesystem::last_write_time(fpath).time_since_epoch().count()),
+                0
+            }, restamp(false) {}
+
+            std::string_view source() {
+                if(!m_source) {
+                    m_source = std::make_unique<MappedFile>(m_fpath);
+                }
+                return m_source->bytes();
+            }
+
+            uint64_t source_hash() {
+                if(key.hash == 0) {
+                    key.hash = cfg_content_hash(source());
+                }
+                return key.hash;
+            }
+
+            bool accept(const CfgImageKey& stored) {
+                if(stored.source != key.source || stored.size != key.size) {
+                    return false;
+                }
+                if(stored.mtime == key.mtime) {
+                    return true;
+                }
+                // touched, but possibly rewritten with the same content
+                restamp = stored.hash == source_hash();
+                return restamp;
+            }
+        };
+
+        // runs f, adding the time it took to *sink when there is one
+        template<typename F>
+        decltype(auto) timed(uint64_t* sink, F&& f) {
+            struct Clock {
+                uint64_t* sink;
+                std::chrono::steady_clock::time_point start;
+                ~Clock() {
+                    if(sink != nullptr) {
+                        *sink += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    }
+                }
+            } clock {sink, std::chrono::steady_clock::now()};
+            return f();
+        }
+
+        uint64_t* phase(CfgLoadPhases* phases, uint64_t CfgLoadPhases::* member) {
+            return phases != nullptr ? &(phases->*member) : nullptr;
+        }
+
+        std::string read_whole(const std::filesystem::path& fpath) {
+            std::ifstream in(fpath, std::ios::binary);
+            if(!in) {
+                throw std::runtime_error(fpath.string() + " can't be opened");
+            }
+            in.seekg(0, std::ios::end);
+            std::string text(static_cast<size_t>(in.tellg()), '\0');
+            in.seekg(0);
+            if(!in.read(text.data(), static_cast<std::streamsize>(text.size()))) {
+                throw std::runtime_error(fpath.string() + " can't be read");
+            }
+            return text;
+        }
+
+        // fpath's bytes, in whatever encoding its name or content says
+        CfgIndex parse_source(const std::filesystem::path& fpath, std::string_view bytes) {
+            return CfgIndex::parse(bytes, cfg_detect_format(fpath, bytes));
+        }
+    }
+
+    std::shared_ptr<const CfgSnapshot> CfgSnapshot::from_file(const std::filesystem::path& fpath, bool use_image, CfgLoadPhases* phases) {
+        uint64_t* const read_ns = phase(phases, &CfgLoadPhases::read_ns);
+        uint64_t* const parse_ns = phase(phases, &CfgLoadPhases::parse_ns);
+        uint64_t* const image_ns = phase(phases, &CfgLoadPhases::image_ns);
+        if(!use_image) {
+            const MappedFile file = timed(read_ns, [&] { return MappedFile(fpath); });
+            return std::make_shared<const CfgSnapshot>(timed(parse_ns, [&] { return parse_source(fpath, file.bytes()); }));
+        }
+
+        SourceCheck check(fpath);
+        const std::filesystem::path image_path = cfg_image_path(fpath);
+        std::optional<CfgIndex> cached = timed(image_ns, [&] {
+            return CfgIndex::open_image(image_path, [&check](const CfgImageKey& stored) {
+                return check.accept(stored);
+            });
+        });
+        if(cached) {
+            if(check.restamp) {
+                // rewritten aside and renamed like a new image, never patched
+                // in place under loaders that have it mapped; a failure only
+                // costs a rehash next time
+                try {
+                    timed(image_ns, [&] { cached->write_image(image_path, check.key); });
+                } catch(const std::exception&) {
+                }
+            }
+            return std::make_shared<const CfgSnapshot>(std::move(*cached));
+        }
+
+        timed(read_ns, [&] { check.source_hash(); });
+        auto snapshot = std::make_shared<const CfgSnapshot>(timed(parse_ns, [&] { return parse_source(fpath, check.source()); }));
+        try {
+            timed(image_ns, [&] { snapshot->index.write_image(image_path, check.key); });
+        } catch(const std::exception&) {
+            // the image is only a cache; a read-only config dir just means
+            // every load parses
+        }
+        return snapshot;
+    }
+
+    std::shared_ptr<const CfgSnapshot> CfgSnapshot::from_shared(const std::filesystem::path& fpath, CfgLoadPhases* phases) {
+        std::unique_ptr<CfgSharedSegments> segments;
+        try {
+            segments = std::make_unique<CfgSharedSegments>(fpath);
+        } catch(const std::system_error&) {
+            return from_file(fpath, false, phases);
+        }
+        uint64_t* const read_ns = phase(phases, &CfgLoadPhases::read_ns);
+        uint64_t* const parse_ns = phase(phases, &CfgLoadPhases::parse_ns);
+        uint64_t* const image_ns = phase(phases, &CfgLoadPhases::image_ns);
+
+        SourceCheck check(fpath);
+        auto attach = [&]() -> std::optional<CfgIndex> {
+            return timed(image_ns, [&]() -> std::optional<CfgIndex> {
+                std::shared_ptr<const MappedFile> image = segments->map(segments->generation());
+                if(!image) {
+                    return std::nullopt;
+                }
+                return CfgIndex::open_image(std::move(image), [&check](const CfgImageKey& stored) {
+                    return check.accept(stored);
+                });
+            });
+        };
+
+        std::optional<CfgIndex> shared = attach();
+        if(!shared) {
+            // one process parses and publishes; the rest wait here and then
+            // find its generation
+            std::lock_guard<CfgSharedSegments> lock(*segments);
+            shared = attach();
+            if(!shared) {
+                timed(read_ns, [&] { check.source_hash(); });
+                CfgIndex parsed = timed(parse_ns, [&] { return parse_source(fpath, check.source()); });
+                try {
+                    timed(image_ns, [&] {
+                        segments->publish(parsed.image_size(check.key), [&](std::byte* dst) {
+                            parsed.write_image(dst, check.key);
+                        });
+                    });
+                } catch(const std::system_error&) {
+                    // e.g. /dev/shm is full: serve this process privately
+                    return std::make_shared<const CfgSnapshot>(std::move(parsed));
+                }
+                shared = attach();
+            }
+        }
+        if(!shared) {
+            throw std::runtime_error("attaching the shared image of " + fpath.string() + " failed");
+        }
+        return std::make_shared<const CfgSnapshot>(std::move(*shared));
+    }
+
+    std::shared_ptr<const CfgSnapshot> CfgSnapshot::from_file_lazy(const std::filesystem::path& fpath, CfgLoadPhases* phases) {
+        // a copy rather than a mapping: sections are parsed long after the
+        // load, when the file may have been rewritten in place, and a
+        // truncated mapping faults on access
+        std::string text = timed(phase(phases, &CfgLoadPhases::read_ns), [&] {
+            return read_whole(fpath);
+        });
+        if(cfg_detect_format(fpath, text) != CfgFormat::Json) {
+            // the section scan only reads text json
+            return std::make_shared<const CfgSnapshot>(timed(phase(phases, &CfgLoadPhases::parse_ns), [&] {
+                return parse_source(fpath, text);
+            }));
+        }
+        return std::make_shared<const CfgSnapshot>(timed(phase(phases, &CfgLoadPhases::parse_ns), [&] {
+            return std::make_unique<const CfgLazyDocument>(std::move(text));
+        }));
+    }
+
+    std::shared_ptr<const CfgSnapshot> CfgSnapshot::from_layers(const std::vector<std::filesystem::path>& fpaths, CfgLoadPhases* phases) {
+        std::vector<CfgIndex> parsed;
+        timed(phase(phases, &CfgLoadPhases::parse_ns), [&] {
+            std::vector<std::future<CfgIndex>> parsing;
+            for(const std::filesystem::path& fpath : fpaths) {
+                parsing.push_back(std::async(std::launch::async, [&fpath] {
+                    const MappedFile file(fpath);
+                    return parse_source(fpath, file.bytes());
+                }));
+            }
+            parsed.reserve(parsing.size());
+            for(std::future<CfgIndex>& layer : parsing) {
+                parsed.push_back(layer.get());
+            }
+        });
+
+        std::vector<std::string> names;
+        for(const std::filesystem::path& fpath : fpaths) {
+            names.push_back(fpath.string());
+        }
+        std::vector<uint16_t> origins;
+        CfgIndex merged = timed(phase(phases, &CfgLoadPhases::parse_ns), [&] {
+            return CfgIndex::merge(parsed, origins);
+        });
+        return std::make_shared<const CfgSnapshot>(std::move(merged), std::move(names), std::move(origins));
+    }
+
+}
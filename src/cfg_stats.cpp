@@ -0,0 +1,213 @@
+#include "cpptanu_cfg/cfg_stats.h"
+#include <tuple>
+#include <utility>
+
+namespace tanu::cfg {
+
+    namespace {
+        constexpr std::array<const char*, static_cast<size_t>(CfgGetter::Count)> GETTER_NAMES {
+            "get_as_int", "get_as_str", "get_as_double",
+            "get_as_int_vec", "get_as_str_vec", "get_as_double_vec",
+            "get_as_int_span", "get_as_double_span", "get_as_str_span",
+            "try_get_as_int", "try_get_as_double", "try_get_as_str",
+            "try_get_as_int_span", "try_get_as_double_span", "try_get_as_str_span",
+            "get_as_str_view", "get_as_int64", "get_as_uint64", "get_as_float", "get_as_bool", "copy_as",
+            "get_unchecked"
+        };
+        constexpr std::array<const char*, static_cast<size_t>(CfgLoadPhase::Count)> PHASE_NAMES {
+            "read", "parse", "image", "validate", "publish"
+        };
+
+        // per-thread cache of the shard this thread records into for each
+        // config, one entry per reader slot like the reader cache in
+        // cfg_read.cpp, so configs never evict each other's entries. an
+        // entry left by a destroyed config is told apart by its instance id.
+        struct ShardCacheEntry {
+            uint64_t instance_id = 0;
+            void* shard = nullptr;
+        };
+        thread_local std::vector<ShardCacheEntry> t_shard_cache;
+
+        // only the owning thread writes, so a relaxed load/store pair is
+        // enough and there is no read-modify-write on the hot path
+        void bump(std::atomic<uint64_t>& counter, uint64_t by) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+        }
+
+        uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    bool cfg_stats_enabled() noexcept {
+#ifdef TANU_CFG_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void CfgLatencyHistogram::merge(const CfgLatencyHistogram& other) noexcept {
+        for(size_t b = 0; b < BUCKETS; b++) {
+            buckets[b] += other.buckets[b];
+        }
+        count += other.count;
+        total_ns += other.total_ns;
+        max_ns = std::max(max_ns, other.max_ns);
+    }
+
+    uint64_t CfgLatencyHistogram::percentile(double q) const noexcept {
+        if(count == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+        uint64_t seen = 0;
+        for(size_t b = 0; b < BUCKETS; b++) {
+            seen += buckets[b];
+            if(seen >= rank) {
+                return b == 0 ? 0 : std::min(max_ns, (uint64_t {1} << b) - 1);
+            }
+        }
+        return max_ns;
+    }
+
+    json CfgLatencyHistogram::to_json() const {
+        json buckets_json = json::array();
+        for(size_t b = 0; b < BUCKETS; b++) {
+            if(buckets[b] != 0) {
+                buckets_json.push_back({{"le_ns", b == 0 ? 0 : (uint64_t {1} << b) - 1}, {"count", buckets[b]}});
+            }
+        }
+        return {
+            {"count", count},
+            {"mean_ns", count == 0 ? 0 : total_ns / count},
+            {"p50_ns", percentile(0.5)},
+            {"p99_ns", percentile(0.99)},
+            {"max_ns", max_ns},
+            {"buckets", std::move(buckets_json)}
+        };
+    }
+
+    json CfgStatsSnapshot::to_json() const {
+        json keys_json = json::array();
+        for(const CfgKeyStats& k : keys) {
+            keys_json.push_back({{"key", k.key}, {"hits", k.hits}, {"misses", k.misses}});
+        }
+        json getters_json = json::object();
+        for(const auto& [name, h] : getters) {
+            getters_json[name] = h.to_json();
+        }
+        json phases_json = json::object();
+        for(const auto& [name, h] : load_phases) {
+            phases_json[name] = h.to_json();
+        }
+        return {{"keys", std::move(keys_json)}, {"getters", std::move(getters_json)}, {"load_phases", std::move(phases_json)}};
+    }
+
+    CfgStats::Scope::~Scope() {
+        const bool hit = !m_missed && std::uncaught_exceptions() == m_uncaught;
+        m_stats.record(m_getter, m_key, hit, elapsed_ns(m_start));
+    }
+
+    void CfgStats::SharedHistogram::add(uint64_t ns) noexcept {
+        bump(buckets[std::min<size_t>(std::bit_width(ns), CfgLatencyHistogram::BUCKETS - 1)], 1);
+        bump(count, 1);
+        bump(total_ns, ns);
+        if(ns > max_ns.load(std::memory_order_relaxed)) {
+            max_ns.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    CfgLatencyHistogram CfgStats::SharedHistogram::load() const noexcept {
+        CfgLatencyHistogram rez;
+        for(size_t b = 0; b < CfgLatencyHistogram::BUCKETS; b++) {
+            rez.buckets[b] = buckets[b].load(std::memory_order_relaxed);
+        }
+        rez.count = count.load(std::memory_order_relaxed);
+        rez.total_ns = total_ns.load(std::memory_order_relaxed);
+        rez.max_ns = max_ns.load(std::memory_order_relaxed);
+        return rez;
+    }
+
+    CfgStats::Shard& CfgStats::local_shard() {
+        if(m_slot < t_shard_cache.size()) [[likely]] {
+            const ShardCacheEntry& entry = t_shard_cache[m_slot];
+            if(entry.instance_id == m_instance_id) [[likely]] {
+                return *static_cast<Shard*>(entry.shard);
+            }
+        } else {
+            t_shard_cache.resize(m_slot + 1);
+        }
+        Shard& shard = register_shard();
+        t_shard_cache[m_slot] = ShardCacheEntry {m_instance_id, &shard};
+        return shard;
+    }
+
+    CfgStats::Shard& CfgStats::register_shard() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_shards.push_back(std::make_unique<Shard>());
+        return *m_shards.back();
+    }
+
+    void CfgStats::record(CfgGetter getter, std::string_view key, bool hit, uint64_t ns) {
+        Shard& shard = local_shard();
+        shard.getters[static_cast<size_t>(getter)].add(ns);
+        // this thread is the only one that inserts, so looking up needs no lock
+        auto it = shard.keys.find(key);
+        if(it == shard.keys.end()) [[unlikely]] {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            it = shard.keys.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+        }
+        bump(hit ? it->second.hits : it->second.misses, 1);
+    }
+
+    void CfgStats::record_phase(CfgLoadPhase phase, uint64_t ns) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_phases[static_cast<size_t>(phase)].add(ns);
+    }
+
+    void CfgStats::record_load(const CfgLoadPhases& phases) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_phases[static_cast<size_t>(CfgLoadPhase::Read)].add(phases.read_ns);
+        m_phases[static_cast<size_t>(CfgLoadPhase::Parse)].add(phases.parse_ns);
+        m_phases[static_cast<size_t>(CfgLoadPhase::Image)].add(phases.image_ns);
+    }
+
+    CfgStatsSnapshot CfgStats::snapshot() const {
+        CfgStatsSnapshot rez;
+        // "id" and "/id" are the same key
+        std::map<std::string, std::pair<uint64_t, uint64_t>, std::less<>> keys;
+        std::array<CfgLatencyHistogram, static_cast<size_t>(CfgGetter::Count)> getters;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for(const auto& shard : m_shards) {
+            std::lock_guard<std::mutex> shard_lock(shard->mtx);
+            for(const auto& [key, counters] : shard->keys) {
+                auto& [hits, misses] = keys[key.starts_with('/') ? key : '/' + key];
+                hits += counters.hits.load(std::memory_order_relaxed);
+                misses += counters.misses.load(std::memory_order_relaxed);
+            }
+            for(size_t g = 0; g < getters.size(); g++) {
+                getters[g].merge(shard->getters[g].load());
+            }
+        }
+        for(auto& [key, counters] : keys) {
+            rez.keys.push_back(CfgKeyStats {key, counters.first, counters.second});
+        }
+        std::stable_sort(rez.keys.begin(), rez.keys.end(), [](const CfgKeyStats& a, const CfgKeyStats& b) {
+            return a.hits + a.misses > b.hits + b.misses;
+        });
+        for(size_t g = 0; g < getters.size(); g++) {
+            if(getters[g].count != 0) {
+                rez.getters.emplace(GETTER_NAMES[g], getters[g]);
+            }
+        }
+        for(size_t p = 0; p < m_phases.size(); p++) {
+            if(m_phases[p].count != 0) {
+                rez.load_phases.emplace(PHASE_NAMES[p], m_phases[p]);
+            }
+        }
+        return rez;
+    }
+
+}
@@ -0,0 +1,122 @@
+#include "cpptanu_cfg/cfg_read.h"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace tanu::cfg {
+
+#ifdef __linux__
+
+    void JSONConfig::watch(const std::string& file_name) {
+        unwatch();
+        load(file_name);
+
+        // watch the file's directory rather than the file so editors and
+        // deploy tools that replace the file by rename are picked up as
+        // well. file_name may name a subdirectory of conf_dir.
+        const std::filesystem::path dir = (std::filesystem::path(this->conf_dir) / file_name).parent_path();
+        const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(inotify_fd < 0) {
+            throw TanuCfgException(std::format("inotify_init1 failed: {}", std::strerror(errno)));
+        }
+        if(inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            const int err = errno;
+            close(inotify_fd);
+            throw TanuCfgException(std::format("inotify_add_watch on {} failed: {}", dir.string(), std::strerror(err)));
+        }
+        this->m_watch_stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(this->m_watch_stop_fd < 0) {
+            const int err = errno;
+            close(inotify_fd);
+            throw TanuCfgException(std::format("eventfd failed: {}", std::strerror(err)));
+        }
+        this->m_watcher = std::thread(&JSONConfig::watch_loop, this, inotify_fd, file_name);
+    }
+
+    void JSONConfig::unwatch() {
+        if(!this->m_watcher.joinable()) {
+            return;
+        }
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t n = write(this->m_watch_stop_fd, &one, sizeof(one));
+        this->m_watcher.join();
+        close(this->m_watch_stop_fd);
+        this->m_watch_stop_fd = -1;
+    }
+
+    void JSONConfig::watch_loop(int inotify_fd, std::string file_name) {
+        const std::filesystem::path fpath = std::filesystem::path(this->conf_dir) / file_name;
+        // events name entries of the watched directory
+        const std::string leaf = fpath.filename().string();
+        alignas(struct inotify_event) char buf[4096];
+        pollfd fds[2] = {
+            {inotify_fd, POLLIN, 0},
+            {this->m_watch_stop_fd, POLLIN, 0}
+        };
+
+        while(true) {
+            if(poll(fds, 2, -1) < 0) {
+                if(errno == EINTR) continue;
+                break;
+            }
+            if(fds[1].revents != 0) {
+                break;
+            }
+
+            bool touched = false;
+            ssize_t len;
+            while((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+                for(char* p = buf; p < buf + len; ) {
+                    const auto* ev = reinterpret_cast<const struct inotify_event*>(p);
+                    if(ev->len > 0 && leaf == ev->name) {
+                        touched = true;
+                    }
+                    p += sizeof(struct inotify_event) + ev->len;
+                }
+            }
+            if(!touched) {
+                continue;
+            }
+
+            // parse and index entirely off the read path; readers keep
+            // using the current snapshot until the swap in publish()
+            try {
+                publish(read_snapshot(fpath));
+                std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+                this->m_reload_error = std::nullopt;
+            } catch(const std::exception& ex) {
+                std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+                this->m_reload_error = std::format("reloading {} failed: {}", fpath.string(), ex.what());
+            }
+        }
+        close(inotify_fd);
+    }
+
+#else
+
+    void JSONConfig::watch(const std::string&) {
+        throw TanuCfgException("watch mode is only supported on linux");
+    }
+
+    void JSONConfig::unwatch() {
+    }
+
+    void JSONConfig::watch_loop(int, std::string) {
+    }
+
+#endif
+
+    std::optional<std::string> JSONConfig::last_reload_error() {
+        std::lock_guard<std::mutex> lock(this->m_publish_mtx);
+        return this->m_reload_error;
+    }
+
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <string>
+#include <vector>
+#include "cpptanu_cfg/cfg_format.h"
+
+using namespace std;
+using namespace tanu::cfg;
+
+// converts a json config into one of the binary encodings JSONConfig::load()
+// reads, so machine-generated configs can skip text parsing:
+//   cpptanu_cfg_convert in.json out.cbor
+//   cpptanu_cfg_convert in.json out.bin --format=msgpack
+// the format comes from --format or, failing that, out's extension.
+
+int main(int argc, char* argv[]) {
+    vector<string> paths;
+    string format_name;
+    for(int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        if(arg.starts_with("--format=")) {
+            format_name = arg.substr(9);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if(paths.size() != 2) {
+        cerr << "usage: cpptanu_cfg_convert <in.json> <out> [--format=cbor|msgpack|bson|json]" << endl;
+        return 2;
+    }
+
+    const optional<CfgFormat> target = format_name.empty()
+        ? optional<CfgFormat> {cfg_detect_format(paths[1], "")}
+        : cfg_format_from_name(format_name);
+    if(!target) {
+        cerr << format("unknown format '{}'", format_name) << endl;
+        return 2;
+    }
+    try {
+        ifstream in(paths[0], ios::binary);
+        if(!in) {
+            throw runtime_error(format("cannot open {}", paths[0]));
+        }
+        const vector<uint8_t> out_bytes = cfg_encode(json::parse(in), *target);
+        ofstream out(paths[1], ios::binary | ios::trunc);
+        out.write(reinterpret_cast<const char*>(out_bytes.data()), static_cast<streamsize>(out_bytes.size()));
+        if(!out) {
+            throw runtime_error(format("cannot write {}", paths[1]));
+        }
+        cout << format("{} -> {} ({}, {} bytes)", paths[0], paths[1], cfg_format_name(*target), out_bytes.size()) << endl;
+    } catch(const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -8,12 +8,65 @@
 #include <cppunit/BriefTestProgressListener.h>
 #include <cppunit/CompilerOutputter.h>
 #include <cppunit/extensions/HelperMacros.h>
+#include "cpptanu_cfg/cfg_batch.h"
+#include "cpptanu_cfg/cfg_format.h"
+#include "cpptanu_cfg/cfg_numeric.h"
 #include "cpptanu_cfg/cfg_read.h"
+#include "cpptanu_cfg/cfg_shm.h"
 #include <filesystem>
+#include <algorithm>
+#include <span>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <optional>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <format>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 using namespace tanu::cfg;
 
+struct UtestSettings {
+    int id;
+    string name;
+    double version;
+    vector<string> tags;
+    int lang_version;
+    vector<int> platform_ids;
+    vector<double> feat_ids;
+    optional<string> special_feature;
+    optional<int> missing;
+};
+
+template<>
+struct tanu::cfg::CfgBinding<UtestSettings> {
+    static constexpr auto fields = make_tuple(
+        cfg_field("id", &UtestSettings::id),
+        cfg_field("/name", &UtestSettings::name),
+        cfg_field("version", &UtestSettings::version),
+        cfg_field("tags", &UtestSettings::tags),
+        cfg_field("detail/lang-version", &UtestSettings::lang_version),
+        cfg_field("detail/appendix/platform_ids", &UtestSettings::platform_ids),
+        cfg_field("detail/appendix/feat_ids", &UtestSettings::feat_ids),
+        cfg_field("detail/appendix/special_feature", &UtestSettings::special_feature),
+        cfg_field("detail/missing", &UtestSettings::missing));
+};
+
+struct MistypedSettings {
+    int name;
+};
+
+template<>
+struct tanu::cfg::CfgBinding<MistypedSettings> {
+    static constexpr auto fields = make_tuple(cfg_field("name", &MistypedSettings::name));
+};
+
 class JSONCfgTestSuite: public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(JSONCfgTestSuite);
     CPPUNIT_TEST(test_load_fail_due_to_broken_json);
@@ -43,6 +96,60 @@ class JSONCfgTestSuite: public CppUnit::TestFixture {
     CPPUNIT_TEST(test_dump_success);
     CPPUNIT_TEST(test_dump_fail_due_to_before_loading);
     CPPUNIT_TEST(test_load_fail_due_to_no_such_file);
+    CPPUNIT_TEST(test_string_view_getters);
+    CPPUNIT_TEST(test_container_key_not_found_as_scalar);
+    CPPUNIT_TEST(test_resolve_success);
+    CPPUNIT_TEST(test_resolve_fail_due_to_type_mismatch);
+    CPPUNIT_TEST(test_resolve_fail_due_to_key_notfound);
+    CPPUNIT_TEST(test_span_success);
+    CPPUNIT_TEST(test_span_fail_due_to_type_mismatch);
+    CPPUNIT_TEST(test_watch_reload_and_keep_on_broken);
+    CPPUNIT_TEST(test_concurrent_read_during_load);
+    CPPUNIT_TEST(test_superseded_snapshot_released);
+    CPPUNIT_TEST(test_dump_matches_json_parse);
+    CPPUNIT_TEST(test_parse_escapes_and_numbers);
+    CPPUNIT_TEST(test_parse_fail_due_to_malformed_json);
+    CPPUNIT_TEST(test_duplicate_keys_keep_last);
+    CPPUNIT_TEST(test_memory_usage_shares_repeated_names);
+    CPPUNIT_TEST(test_compiled_cache_reused_and_invalidated);
+    CPPUNIT_TEST(test_shared_memory_generations);
+    CPPUNIT_TEST(test_bind_struct_success);
+    CPPUNIT_TEST(test_bind_struct_fail_due_to_type_mismatch);
+    CPPUNIT_TEST(test_try_get_success);
+    CPPUNIT_TEST(test_try_get_errors_and_defaults);
+    CPPUNIT_TEST(test_latency_histogram_percentiles);
+    CPPUNIT_TEST(test_stats_count_hits_and_misses);
+    CPPUNIT_TEST(test_load_layers_deep_merge);
+    CPPUNIT_TEST(test_load_layers_provenance);
+    CPPUNIT_TEST(test_keys_with_prefix);
+    CPPUNIT_TEST(test_subtree_and_array_size);
+    CPPUNIT_TEST(test_lazy_sections_materialize_on_demand);
+    CPPUNIT_TEST(test_lazy_section_errors_deferred);
+    CPPUNIT_TEST(test_load_async);
+    CPPUNIT_TEST(test_load_all_reports_per_file_errors);
+    CPPUNIT_TEST(test_registry_shares_snapshots);
+    CPPUNIT_TEST(test_registry_single_flight_and_reload);
+    CPPUNIT_TEST(test_load_binary_formats);
+    CPPUNIT_TEST(test_detect_format_by_magic);
+    CPPUNIT_TEST(test_subscribers_get_prefix_diffs);
+    CPPUNIT_TEST(test_diff_and_unsubscribe);
+    CPPUNIT_TEST(test_str_view_shares_interned_bytes);
+    CPPUNIT_TEST(test_str_view_outlives_reload_with_snapshot);
+    CPPUNIT_TEST(test_wide_scalar_getters);
+    CPPUNIT_TEST(test_copy_as_matches_scalar_conversion);
+    CPPUNIT_TEST(test_schema_rejects_nonconforming_load);
+    CPPUNIT_TEST(test_schema_unchecked_getters);
+    CPPUNIT_TEST(test_stream_dump_matches_string_dumps);
+    CPPUNIT_TEST(test_stream_dump_prefix_depth_and_fd);
+    CPPUNIT_TEST(test_hashed_key_literals_match_string_getters);
+    CPPUNIT_TEST(test_hashed_key_errors_and_lazy_sections);
+    CPPUNIT_TEST(test_lazy_snapshot_survives_in_place_rewrite);
+    CPPUNIT_TEST(test_spans_survive_reads_of_other_configs);
+    CPPUNIT_TEST(test_untrusted_images_rejected);
+    CPPUNIT_TEST(test_shared_memory_private_to_user);
+    CPPUNIT_TEST(test_schema_inclusive_and_exclusive_bounds);
+    CPPUNIT_TEST(test_int_getters_check_range);
+    CPPUNIT_TEST(test_stream_dump_drops_duplicate_keys);
     CPPUNIT_TEST_SUITE_END();
     JSONConfig* json_cfg;
 
@@ -82,6 +189,60 @@ protected:
     void test_dump_success();
     void test_dump_fail_due_to_before_loading();
     void test_load_fail_due_to_no_such_file();
+    void test_string_view_getters();
+    void test_container_key_not_found_as_scalar();
+    void test_resolve_success();
+    void test_resolve_fail_due_to_type_mismatch();
+    void test_resolve_fail_due_to_key_notfound();
+    void test_span_success();
+    void test_span_fail_due_to_type_mismatch();
+    void test_watch_reload_and_keep_on_broken();
+    void test_concurrent_read_during_load();
+    void test_superseded_snapshot_released();
+    void test_dump_matches_json_parse();
+    void test_parse_escapes_and_numbers();
+    void test_parse_fail_due_to_malformed_json();
+    void test_duplicate_keys_keep_last();
+    void test_memory_usage_shares_repeated_names();
+    void test_compiled_cache_reused_and_invalidated();
+    void test_shared_memory_generations();
+    void test_bind_struct_success();
+    void test_bind_struct_fail_due_to_type_mismatch();
+    void test_try_get_success();
+    void test_try_get_errors_and_defaults();
+    void test_latency_histogram_percentiles();
+    void test_stats_count_hits_and_misses();
+    void test_load_layers_deep_merge();
+    void test_load_layers_provenance();
+    void test_keys_with_prefix();
+    void test_subtree_and_array_size();
+    void test_lazy_sections_materialize_on_demand();
+    void test_lazy_section_errors_deferred();
+    void test_load_async();
+    void test_load_all_reports_per_file_errors();
+    void test_registry_shares_snapshots();
+    void test_registry_single_flight_and_reload();
+    void test_load_binary_formats();
+    void test_detect_format_by_magic();
+    void test_subscribers_get_prefix_diffs();
+    void test_diff_and_unsubscribe();
+    void test_str_view_shares_interned_bytes();
+    void test_str_view_outlives_reload_with_snapshot();
+    void test_wide_scalar_getters();
+    void test_copy_as_matches_scalar_conversion();
+    void test_schema_rejects_nonconforming_load();
+    void test_schema_unchecked_getters();
+    void test_stream_dump_matches_string_dumps();
+    void test_stream_dump_prefix_depth_and_fd();
+    void test_hashed_key_literals_match_string_getters();
+    void test_hashed_key_errors_and_lazy_sections();
+    void test_lazy_snapshot_survives_in_place_rewrite();
+    void test_spans_survive_reads_of_other_configs();
+    void test_untrusted_images_rejected();
+    void test_shared_memory_private_to_user();
+    void test_schema_inclusive_and_exclusive_bounds();
+    void test_int_getters_check_range();
+    void test_stream_dump_drops_duplicate_keys();
 };
 
 void JSONCfgTestSuite::test_load_fail_due_to_broken_json() {
@@ -415,6 +576,1228 @@ void JSONCfgTestSuite::test_load_fail_due_to_no_such_file() {
     }
 }
 
+void JSONCfgTestSuite::test_string_view_getters() {
+    json_cfg->load("utest.json");
+    const string_view lang_ver_key {"detail/lang-version"};
+    CPPUNIT_ASSERT_EQUAL(10, json_cfg->get_as_int(lang_ver_key));
+    const string_view lang_patch_key {"/detail/lang-patch"};
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2864, json_cfg->get_as_double(lang_patch_key), 0.000001);
+    const string lang_key {"detail/lang"};
+    CPPUNIT_ASSERT_EQUAL(string {"c++"}, json_cfg->get_as_str(string_view {lang_key}));
+    CPPUNIT_ASSERT_EQUAL(string {"cat"}, json_cfg->get_as_str(string_view {"tags/1"}));
+    vector<int> expected {1, 0};
+    CPPUNIT_ASSERT(expected == json_cfg->get_as_int_vec(string_view {"detail/appendix/platform_ids"}));
+}
+
+void JSONCfgTestSuite::test_container_key_not_found_as_scalar() {
+    json_cfg->load("utest.json");
+    try {
+        json_cfg->get_as_str("detail");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& json_e) {
+        string msg {json_e.what()};
+        CPPUNIT_ASSERT_EQUAL(true, msg.find("key \'/detail\' not found") != std::string::npos);
+    }
+}
+
+void JSONCfgTestSuite::test_resolve_success() {
+    json_cfg->load("utest.json");
+    const CfgKey<int> lang_ver = json_cfg->resolve<int>("detail/lang-version");
+    const CfgKey<double> lang_patch = json_cfg->resolve<double>("/detail/lang-patch");
+    const CfgKey<string> lang = json_cfg->resolve<string>("detail/lang");
+    CPPUNIT_ASSERT_EQUAL(true, lang_ver.valid());
+    CPPUNIT_ASSERT_EQUAL(10, lang_ver.get());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2864, *lang_patch, 0.000001);
+    CPPUNIT_ASSERT(string_view {"c++"} == lang.get());
+
+    // handles keep reading the version they were resolved against
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT_EQUAL(10, lang_ver.get());
+    CPPUNIT_ASSERT_EQUAL(false, CfgKey<int>{}.valid());
+}
+
+void JSONCfgTestSuite::test_resolve_fail_due_to_type_mismatch() {
+    json_cfg->load("utest.json");
+    try {
+        json_cfg->resolve<int>("/name");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& ex) {
+        CPPUNIT_ASSERT_EQUAL(string{"/name's value is not integer"}, string{ex.what()});
+    }
+    try {
+        json_cfg->resolve<string>("id");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& ex) {
+        CPPUNIT_ASSERT_EQUAL(string{"/id's value is not string"}, string{ex.what()});
+    }
+}
+
+void JSONCfgTestSuite::test_resolve_fail_due_to_key_notfound() {
+    try {
+        json_cfg->resolve<double>("version");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& e) {
+        CPPUNIT_ASSERT_EQUAL(string {"Json config hasn't loaded yet"}, string{e.what()});
+    }
+    json_cfg->load("utest.json");
+    try {
+        json_cfg->resolve<double>("/nowawawa");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& json_e) {
+        string msg {json_e.what()};
+        CPPUNIT_ASSERT_EQUAL(true, msg.find("key \'/nowawawa\' not found") != std::string::npos);
+    }
+}
+
+void JSONCfgTestSuite::test_span_success() {
+    json_cfg->load("utest.json");
+    const span<const int64_t> pids = json_cfg->get_as_int_span("detail/appendix/platform_ids");
+    CPPUNIT_ASSERT_EQUAL(size_t {2}, pids.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t {1}, pids[0]);
+    CPPUNIT_ASSERT_EQUAL(int64_t {0}, pids[1]);
+    const span<const double> fids = json_cfg->get_as_double_span("/detail/appendix/feat_ids");
+    vector<double> expected_fids {210.45, 18.10, 395.45};
+    CPPUNIT_ASSERT(equal(expected_fids.begin(), expected_fids.end(), fids.begin(), fids.end()));
+    const span<const string_view> tags = json_cfg->get_as_str_span("tags");
+    vector<string_view> expected_tags {"neko", "cat", "pokora"};
+    CPPUNIT_ASSERT(equal(expected_tags.begin(), expected_tags.end(), tags.begin(), tags.end()));
+    // repeated reads hand out the same storage
+    CPPUNIT_ASSERT(fids.data() == json_cfg->get_as_double_span("detail/appendix/feat_ids").data());
+}
+
+void JSONCfgTestSuite::test_span_fail_due_to_type_mismatch() {
+    json_cfg->load("utest.json");
+    try {
+        json_cfg->get_as_double_span("/detail/appendix/platform_ids");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& ex) {
+        CPPUNIT_ASSERT_EQUAL(string{"/detail/appendix/platform_ids's value is not double"}, string{ex.what()});
+    }
+    try {
+        json_cfg->get_as_int_span("/id");
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& ex) {
+        string msg {ex.what()};
+        CPPUNIT_ASSERT_EQUAL(true, msg.find("key \'/id\' not found") != std::string::npos);
+    }
+}
+
+void JSONCfgTestSuite::test_watch_reload_and_keep_on_broken() {
+    const auto cfg_path = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "watch.json";
+    auto write_cfg = [&](const string& body) {
+        // write aside and rename in, the way deploy tools replace files
+        const auto tmp_path = cfg_path.string() + ".tmp";
+        ofstream(tmp_path) << body;
+        filesystem::rename(tmp_path, cfg_path);
+    };
+    auto wait_for = [](auto cond) {
+        for(int i = 0; i < 500 && !cond(); i++) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        return cond();
+    };
+
+    write_cfg(R"({"id": 1, "name": "tako"})");
+    json_cfg->watch("watch.json");
+    CPPUNIT_ASSERT_EQUAL(1, json_cfg->get_as_int("id"));
+    const uint64_t first_version = json_cfg->version();
+
+    write_cfg(R"({"id": 2, "name": "ika"})");
+    CPPUNIT_ASSERT_EQUAL(true, wait_for([&]{ return json_cfg->version() > first_version; }));
+    CPPUNIT_ASSERT_EQUAL(2, json_cfg->get_as_int("id"));
+    CPPUNIT_ASSERT_EQUAL(string {"ika"}, json_cfg->get_as_str("name"));
+
+    write_cfg(R"({"broken")");
+    CPPUNIT_ASSERT_EQUAL(true, wait_for([&]{ return json_cfg->last_reload_error().has_value(); }));
+    CPPUNIT_ASSERT_EQUAL(2, json_cfg->get_as_int("id"));
+
+    json_cfg->unwatch();
+    filesystem::remove(cfg_path);
+
+    // a config in a subdirectory of conf_dir reloads as well
+    const auto sub_dir = cfg_path.parent_path() / "watch_sub";
+    filesystem::create_directory(sub_dir);
+    const auto sub_path = sub_dir / "watch.json";
+    ofstream(sub_path) << R"({"id": 3})";
+    json_cfg->watch("watch_sub/watch.json");
+    CPPUNIT_ASSERT_EQUAL(3, json_cfg->get_as_int("id"));
+    const uint64_t sub_version = json_cfg->version();
+    ofstream(sub_path) << R"({"id": 4})";
+    CPPUNIT_ASSERT_EQUAL(true, wait_for([&]{ return json_cfg->version() > sub_version; }));
+    CPPUNIT_ASSERT_EQUAL(4, json_cfg->get_as_int("id"));
+    json_cfg->unwatch();
+    filesystem::remove_all(sub_dir);
+}
+
+void JSONCfgTestSuite::test_concurrent_read_during_load() {
+    json_cfg->load("utest.json");
+    atomic<bool> stop {false};
+    atomic<int> bad_reads {0};
+    vector<thread> readers;
+    for(int t = 0; t < 4; t++) {
+        readers.emplace_back([&] {
+            while(!stop.load()) {
+                if(json_cfg->get_as_int("detail/lang-version") != 10 || json_cfg->get_as_str("tags/2") != "pokora") {
+                    bad_reads++;
+                }
+            }
+        });
+    }
+    for(int i = 0; i < 50; i++) {
+        json_cfg->load("utest.json");
+    }
+    stop = true;
+    for(auto& r : readers) {
+        r.join();
+    }
+    CPPUNIT_ASSERT_EQUAL(0, bad_reads.load());
+}
+
+void JSONCfgTestSuite::test_superseded_snapshot_released() {
+    json_cfg->load("utest.json");
+    weak_ptr<const CfgSnapshot> first = json_cfg->snapshot();
+    json_cfg->load("utest.json");
+    // the next read on this thread moves its cached snapshot forward
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->get_as_int("id"));
+    CPPUNIT_ASSERT_EQUAL(true, first.expired());
+}
+
+void JSONCfgTestSuite::test_dump_matches_json_parse() {
+    json_cfg->load("utest.json");
+    ifstream ifs(filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "utest.json");
+    const json expected = json::parse(ifs);
+    CPPUNIT_ASSERT_EQUAL(expected.dump(), json_cfg->dump_cfg().value());
+    CPPUNIT_ASSERT_EQUAL(expected.flatten().dump(), json_cfg->dump_flattened_view().value());
+}
+
+void JSONCfgTestSuite::test_parse_escapes_and_numbers() {
+    const string text = R"({
+        "esc": "a\"b\\c\/d\n\u00e9\ud83d\ude00",
+        "a/b": {"c~d": 1},
+        "big": 18446744073709551615,
+        "neg": -9223372036854775808,
+        "huge": 123456789012345678901234567890,
+        "exp": -1.5e3,
+        "flags": [true, false, null],
+        "empty": {"o": {}, "a": []}
+    })";
+    const CfgIndex index = CfgIndex::parse(text);
+    CPPUNIT_ASSERT(index.to_json() == json::parse(text));
+    CPPUNIT_ASSERT(index.to_flattened_json() == json::parse(text).flatten());
+    CPPUNIT_ASSERT(string_view {"a\"b\\c/d\n\u00e9\U0001F600"} == index.str(*index.find("esc")));
+    CPPUNIT_ASSERT_EQUAL(int64_t {1}, index.find("a~1b/c~0d")->i);
+    CPPUNIT_ASSERT(CfgType::UInt == index.find("big")->type);
+    CPPUNIT_ASSERT_EQUAL(INT64_MIN, index.find("/neg")->i);
+    CPPUNIT_ASSERT(CfgType::Double == index.find("huge")->type);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-1500.0, index.find("exp")->d, 0.0);
+}
+
+void JSONCfgTestSuite::test_parse_fail_due_to_malformed_json() {
+    const vector<string> broken {
+        "", "{", "{\"a\" 1}", "{\"a\": 1,}", "[1, 2", "[01]", "{\"a\": tru}",
+        "\"unterminated", "\"bad \\x escape\"", "{} {}", "[1.]", "[-]", "\"\\udc00\""
+    };
+    for(const string& text : broken) {
+        try {
+            CfgIndex::parse(text);
+            CPPUNIT_FAIL("shouldn't reach here: " + text);
+        } catch(const runtime_error& e) {
+            CPPUNIT_ASSERT_EQUAL(true, string {e.what()}.find("json parse error") != string::npos
+                || string {e.what()}.find("incomplete document") != string::npos);
+        }
+    }
+}
+
+void JSONCfgTestSuite::test_duplicate_keys_keep_last() {
+    const string text = R"({"a": {"x": 1, "y": 2}, "b": [1], "a": {"x": 3}, "b": {"0": 4}})";
+    const CfgIndex index = CfgIndex::parse(text);
+    CPPUNIT_ASSERT_EQUAL(int64_t {3}, index.find("a/x")->i);
+    CPPUNIT_ASSERT_EQUAL(int64_t {4}, index.find("/b/0")->i);
+    CPPUNIT_ASSERT(index.find("a/y") == nullptr);
+    CPPUNIT_ASSERT(index.find("a/x/") == nullptr);
+    CPPUNIT_ASSERT(index.find("/x") == nullptr);
+
+    // the replaced value goes with everything below it, so lookups and
+    // dumps agree with json::parse of the same text
+    const string nested = R"({"a": {"x": 1}, "a": {"y": 2}, "b": {"c": [1, 2]}, "b": {"c": 5}})";
+    const json parsed = json::parse(nested);
+    const CfgIndex replaced = CfgIndex::parse(nested);
+    CPPUNIT_ASSERT(replaced.find("a/x") == nullptr);
+    CPPUNIT_ASSERT(replaced.find("b/c/0") == nullptr);
+    CPPUNIT_ASSERT(replaced.find("b/c/1") == nullptr);
+    CPPUNIT_ASSERT_EQUAL(parsed, replaced.to_json());
+    CPPUNIT_ASSERT_EQUAL(parsed.flatten(), replaced.to_flattened_json());
+
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "dup_tmp.json";
+    ofstream(fpath) << nested;
+    json_cfg->load("dup_tmp.json");
+    const json flat = parsed.flatten();
+    for(const auto& item : flat.items()) {
+        CPPUNIT_ASSERT_EQUAL(item.value().get<int>(), json_cfg->get_as_int(item.key()));
+    }
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("a/x"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("b/c/0"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(parsed.dump(), json_cfg->dump_cfg().value());
+    CPPUNIT_ASSERT_EQUAL(flat.dump(), json_cfg->dump_flattened_view().value());
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_memory_usage_shares_repeated_names() {
+    CPPUNIT_ASSERT_EQUAL(size_t {0}, json_cfg->memory_usage().total());
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT(json_cfg->memory_usage().total() > 0);
+
+    string one = R"({"routes": [{"host": "a.example", "port": 1}]})";
+    string many = R"({"routes": [{"host": "a.example", "port": 1})";
+    for(int i = 2; i <= 100; i++) {
+        many += R"(, {"host": "a.example", "port": )" + to_string(i) + "}";
+    }
+    many += "]}";
+    const CfgMemoryUsage one_usage = CfgIndex::parse(one).memory_usage();
+    const CfgMemoryUsage many_usage = CfgIndex::parse(many).memory_usage();
+    CPPUNIT_ASSERT_EQUAL(one_usage.keys, many_usage.keys);
+    CPPUNIT_ASSERT_EQUAL(one_usage.strings, many_usage.strings);
+    CPPUNIT_ASSERT(many_usage.values > one_usage.values);
+}
+void JSONCfgTestSuite::test_compiled_cache_reused_and_invalidated() {
+    const auto dir = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg";
+    const auto cfg_path = dir / "cached.json";
+    const auto image_path = cfg_image_path(cfg_path);
+    filesystem::copy_file(dir / "utest.json", cfg_path, filesystem::copy_options::overwrite_existing);
+    filesystem::remove(image_path);
+
+    json_cfg->set_compiled_cache(true);
+    json_cfg->load("cached.json");
+    CPPUNIT_ASSERT_EQUAL(true, filesystem::exists(image_path));
+
+    // a second loader maps the image instead of parsing
+    JSONConfig warm {"cpptanu_cfg_utest", "tanu_cfg"};
+    warm.set_compiled_cache(true);
+    const auto image_written = filesystem::last_write_time(image_path);
+    warm.load("cached.json");
+    CPPUNIT_ASSERT(image_written == filesystem::last_write_time(image_path));
+    CPPUNIT_ASSERT_EQUAL(json_cfg->dump_cfg().value(), warm.dump_cfg().value());
+    CPPUNIT_ASSERT_EQUAL(string {"tako"}, warm.get_as_str("name"));
+    CPPUNIT_ASSERT_EQUAL(string {"pokora"}, warm.get_as_str_vec("tags")[2]);
+
+    // touched but unchanged content keeps the image. its new stamp goes
+    // into a replacement file, not into the one json_cfg still maps
+    struct stat before;
+    CPPUNIT_ASSERT_EQUAL(0, stat(image_path.c_str(), &before));
+    filesystem::last_write_time(cfg_path, filesystem::last_write_time(cfg_path) + chrono::seconds(5));
+    warm.load("cached.json");
+    CPPUNIT_ASSERT_EQUAL(32, warm.get_as_int("id"));
+    struct stat after;
+    CPPUNIT_ASSERT_EQUAL(0, stat(image_path.c_str(), &after));
+    CPPUNIT_ASSERT(before.st_ino != after.st_ino);
+    CPPUNIT_ASSERT_EQUAL(string {"tako"}, json_cfg->get_as_str("name"));
+
+    // changed content, or an unreadable image, falls back to parsing
+    ofstream(cfg_path) << R"({"id": 33})";
+    warm.load("cached.json");
+    CPPUNIT_ASSERT_EQUAL(33, warm.get_as_int("id"));
+    ofstream(image_path) << "not an image";
+    json_cfg->load("cached.json");
+    CPPUNIT_ASSERT_EQUAL(33, json_cfg->get_as_int("id"));
+
+    filesystem::remove(cfg_path);
+    filesystem::remove(image_path);
+}
+void JSONCfgTestSuite::test_shared_memory_generations() {
+    const auto dir = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg";
+    const auto cfg_path = dir / "shared.json";
+    filesystem::copy_file(dir / "utest.json", cfg_path, filesystem::copy_options::overwrite_existing);
+    CfgSharedSegments::unlink(cfg_path);
+
+    json_cfg->set_shared_memory(true);
+    json_cfg->load("shared.json");
+    JSONConfig other {"cpptanu_cfg_utest", "tanu_cfg"};
+    other.set_shared_memory(true);
+    other.load("shared.json");
+    // the second loader attached to what the first one published
+    CPPUNIT_ASSERT_EQUAL(uint64_t {1}, CfgSharedSegments(cfg_path).generation());
+    CPPUNIT_ASSERT_EQUAL(json_cfg->dump_cfg().value(), other.dump_cfg().value());
+    CPPUNIT_ASSERT_EQUAL(string {"c++"}, other.get_as_str("detail/lang"));
+    CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(other.get_as_double_vec("detail/appendix/feat_ids").size()));
+
+    // an update is published once and picked up by every later load
+    ofstream(cfg_path) << R"({"id": 33})";
+    other.load("shared.json");
+    CPPUNIT_ASSERT_EQUAL(33, other.get_as_int("id"));
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->get_as_int("id"));
+    json_cfg->load("shared.json");
+    CPPUNIT_ASSERT_EQUAL(33, json_cfg->get_as_int("id"));
+    CPPUNIT_ASSERT_EQUAL(uint64_t {2}, CfgSharedSegments(cfg_path).generation());
+
+    CfgSharedSegments::unlink(cfg_path);
+    filesystem::remove(cfg_path);
+}
+void JSONCfgTestSuite::test_bind_struct_success() {
+    json_cfg->load("utest.json");
+    const UtestSettings settings = json_cfg->bind<UtestSettings>();
+    CPPUNIT_ASSERT_EQUAL(32, settings.id);
+    CPPUNIT_ASSERT_EQUAL(string {"tako"}, settings.name);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.28, settings.version, 0.000001);
+    CPPUNIT_ASSERT(settings.tags == json_cfg->get_as_str_vec("tags"));
+    CPPUNIT_ASSERT_EQUAL(10, settings.lang_version);
+    CPPUNIT_ASSERT(settings.platform_ids == (vector<int> {1, 0}));
+    CPPUNIT_ASSERT(settings.feat_ids == json_cfg->get_as_double_vec("detail/appendix/feat_ids"));
+    CPPUNIT_ASSERT_EQUAL(string {"VECTOR"}, settings.special_feature.value());
+    CPPUNIT_ASSERT_EQUAL(false, settings.missing.has_value());
+    static_assert(!cfg_paths_unique(make_tuple(cfg_field("id", &UtestSettings::id), cfg_field("/id", &UtestSettings::lang_version))));
+}
+
+void JSONCfgTestSuite::test_bind_struct_fail_due_to_type_mismatch() {
+    json_cfg->load("utest.json");
+    try {
+        json_cfg->bind<MistypedSettings>();
+        CPPUNIT_FAIL("shouldn't reach here");
+    } catch(const TanuCfgException& e) {
+        CPPUNIT_ASSERT_EQUAL(string {"/name's value is not integer"}, string {e.what()});
+    }
+}
+void JSONCfgTestSuite::test_try_get_success() {
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->try_get_as_int("id").value());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2864, json_cfg->try_get_as_double("/detail/lang-patch").value(), 0.000001);
+    CPPUNIT_ASSERT(string_view {"tako"} == json_cfg->try_get_as_str("name").value());
+    CPPUNIT_ASSERT_EQUAL(size_t {2}, json_cfg->try_get_as_int_span("detail/appendix/platform_ids")->size());
+    CPPUNIT_ASSERT_EQUAL(size_t {3}, json_cfg->try_get_as_double_span("detail/appendix/feat_ids")->size());
+    CPPUNIT_ASSERT(string_view {"cat"} == (*json_cfg->try_get_as_str_span("tags"))[1]);
+    CPPUNIT_ASSERT_EQUAL(10, json_cfg->get_or("detail/lang-version", 0));
+    CPPUNIT_ASSERT(string_view {"c++"} == json_cfg->get_or("detail/lang", "none"));
+}
+
+void JSONCfgTestSuite::test_try_get_errors_and_defaults() {
+    auto not_loaded = json_cfg->try_get_as_int("id");
+    CPPUNIT_ASSERT(CfgErrc::NotLoaded == not_loaded.error().code);
+    CPPUNIT_ASSERT_EQUAL(7, json_cfg->get_or("id", 7));
+
+    json_cfg->load("utest.json");
+    auto missing = json_cfg->try_get_as_double("nope/x");
+    CPPUNIT_ASSERT(CfgErrc::NotFound == missing.error().code);
+    CPPUNIT_ASSERT_EQUAL(string {"key '/nope/x' not found"}, missing.error().message());
+    auto mistyped = json_cfg->try_get_as_int("name");
+    CPPUNIT_ASSERT(CfgErrc::TypeMismatch == mistyped.error().code);
+    CPPUNIT_ASSERT_EQUAL(string {"/name's value is not integer"}, mistyped.error().message());
+    CPPUNIT_ASSERT(CfgErrc::NotFound == json_cfg->try_get_as_int("detail").error().code);
+    CPPUNIT_ASSERT(CfgErrc::TypeMismatch == json_cfg->try_get_as_double_span("tags").error().code);
+    CPPUNIT_ASSERT(CfgErrc::NotFound == json_cfg->try_get_as_str_span("name").error().code);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, json_cfg->get_or("name", 0.5), 0.0);
+    CPPUNIT_ASSERT(string_view {"fallback"} == json_cfg->get_or("id", "fallback"));
+}
+void JSONCfgTestSuite::test_latency_histogram_percentiles() {
+    CfgLatencyHistogram h;
+    CPPUNIT_ASSERT_EQUAL(uint64_t {0}, h.percentile(0.99));
+    for(int i = 0; i < 99; i++) {
+        h.add(100);
+    }
+    h.add(5000);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {100}, h.count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {127}, h.percentile(0.5));
+    CPPUNIT_ASSERT_EQUAL(uint64_t {127}, h.percentile(0.99));
+    CPPUNIT_ASSERT_EQUAL(uint64_t {5000}, h.percentile(1.0));
+    CfgLatencyHistogram other;
+    other.add(3);
+    h.merge(other);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {101}, h.count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {3}, h.percentile(0.0));
+}
+
+void JSONCfgTestSuite::test_stats_count_hits_and_misses() {
+    json_cfg->load("utest.json");
+    json_cfg->get_as_int("id");
+    json_cfg->get_as_int("/id");
+    json_cfg->get_or("nope", 1);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_str("nope"), TanuCfgException);
+    const CfgStatsSnapshot stats = json_cfg->stats();
+    if(!cfg_stats_enabled()) {
+        CPPUNIT_ASSERT(stats.keys.empty() && stats.getters.empty() && stats.load_phases.empty());
+        return;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t {2}, stats.keys.size());
+    CPPUNIT_ASSERT_EQUAL(string {"/id"}, stats.keys[0].key);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {2}, stats.keys[0].hits);
+    CPPUNIT_ASSERT_EQUAL(string {"/nope"}, stats.keys[1].key);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {0}, stats.keys[1].hits);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {2}, stats.keys[1].misses);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {2}, stats.getters.at("get_as_int").count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {1}, stats.getters.at("try_get_as_int").count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {1}, stats.load_phases.at("parse").count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {1}, stats.load_phases.at("publish").count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t {2}, json_cfg->stats().to_json()["keys"][0]["hits"].get<uint64_t>());
+
+    // configs read in turn on one thread and on another each keep their counts
+    vector<unique_ptr<JSONConfig>> cfgs;
+    for(int i = 0; i < 20; i++) {
+        cfgs.push_back(make_unique<JSONConfig>("cpptanu_cfg_utest", "tanu_cfg"));
+        cfgs.back()->load("utest.json");
+    }
+    auto read_all = [&cfgs]() {
+        for(int round = 0; round < 3; round++) {
+            for(const auto& cfg : cfgs) {
+                cfg->get_as_int("id");
+            }
+        }
+    };
+    read_all();
+    thread(read_all).join();
+    for(const auto& cfg : cfgs) {
+        const CfgStatsSnapshot each = cfg->stats();
+        CPPUNIT_ASSERT_EQUAL(size_t {1}, each.keys.size());
+        CPPUNIT_ASSERT_EQUAL(uint64_t {6}, each.keys[0].hits);
+        CPPUNIT_ASSERT_EQUAL(uint64_t {6}, each.getters.at("get_as_int").count);
+    }
+}
+void JSONCfgTestSuite::test_load_layers_deep_merge() {
+    json_cfg->load_layers({"utest.json", "utest_host.json"});
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->get_as_int("id"));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, json_cfg->get_as_double("version"), 0.0);
+    CPPUNIT_ASSERT_EQUAL(string {"neko"}, json_cfg->get_as_str("owner"));
+    CPPUNIT_ASSERT_EQUAL(string {"c++"}, json_cfg->get_as_str("detail/lang"));
+    CPPUNIT_ASSERT_EQUAL(23, json_cfg->get_as_int("detail/lang-version"));
+    // arrays are replaced, not merged
+    CPPUNIT_ASSERT(vector<string> {"cxx"} == json_cfg->get_as_str_vec("detail/alias"));
+    CPPUNIT_ASSERT_EQUAL(string {"LINUX"}, json_cfg->get_as_str("detail/appendix/platform"));
+    CPPUNIT_ASSERT_EQUAL(string {"VECTOR"}, json_cfg->get_as_str("detail/appendix/special_feature"));
+    CPPUNIT_ASSERT_EQUAL(size_t {3}, json_cfg->get_as_double_span("detail/appendix/feat_ids").size());
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_str("detail/alias/1"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->load_layers({"utest.json", "broken.json"}), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(23, json_cfg->get_as_int("detail/lang-version"));
+}
+
+void JSONCfgTestSuite::test_load_layers_provenance() {
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT(!json_cfg->provenance("id").has_value());
+
+    json_cfg->load_layers({"utest.json", "utest_host.json"});
+    CPPUNIT_ASSERT(json_cfg->provenance("id")->ends_with("/utest.json"));
+    CPPUNIT_ASSERT(json_cfg->provenance("detail/lang")->ends_with("/utest.json"));
+    CPPUNIT_ASSERT(json_cfg->provenance("detail/lang-version")->ends_with("/utest_host.json"));
+    CPPUNIT_ASSERT(json_cfg->provenance("detail/alias/0")->ends_with("/utest_host.json"));
+    CPPUNIT_ASSERT(json_cfg->provenance("detail/appendix/platform_ids/1")->ends_with("/utest.json"));
+    CPPUNIT_ASSERT(json_cfg->provenance("detail")->ends_with("/utest_host.json"));
+    CPPUNIT_ASSERT(!json_cfg->provenance("nope").has_value());
+}
+void JSONCfgTestSuite::test_keys_with_prefix() {
+    json_cfg->load("utest.json");
+    vector<string> keys;
+    for(string_view key : json_cfg->keys_with_prefix("detail/appendix/")) {
+        keys.emplace_back(key);
+    }
+    const vector<string> expected {
+        "/detail/appendix/special_feature",
+        "/detail/appendix/platform/0", "/detail/appendix/platform/1",
+        "/detail/appendix/platform_ids/0", "/detail/appendix/platform_ids/1",
+        "/detail/appendix/feat_ids/0", "/detail/appendix/feat_ids/1", "/detail/appendix/feat_ids/2"};
+    CPPUNIT_ASSERT(expected == keys);
+
+    keys.clear();
+    for(string_view key : json_cfg->keys_with_prefix("/detail/lang")) {
+        keys.emplace_back(key);
+    }
+    CPPUNIT_ASSERT((vector<string> {"/detail/lang", "/detail/lang-version", "/detail/lang-patch"}) == keys);
+    CPPUNIT_ASSERT_EQUAL(ptrdiff_t {20}, ranges::distance(json_cfg->keys_with_prefix("")));
+    CPPUNIT_ASSERT_EQUAL(ptrdiff_t {0}, ranges::distance(json_cfg->keys_with_prefix("nope/")));
+    CPPUNIT_ASSERT_EQUAL(ptrdiff_t {0}, ranges::distance(json_cfg->keys_with_prefix("id/")));
+
+    // a repeated member name lists only the last value's keys
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "dup_tmp.json";
+    ofstream(fpath) << R"({"a":{"x":1},"a":{"y":2},"b":{"c":[1,2]},"b":{"c":5}})";
+    for(const bool lazy : {false, true}) {
+        json_cfg->set_lazy_sections(lazy);
+        json_cfg->load("dup_tmp.json");
+        keys.clear();
+        for(string_view key : json_cfg->keys_with_prefix("")) {
+            keys.emplace_back(key);
+        }
+        CPPUNIT_ASSERT((vector<string> {"/a/y", "/b/c"}) == keys);
+        CPPUNIT_ASSERT_EQUAL(ptrdiff_t {0}, ranges::distance(json_cfg->keys_with_prefix("a/x")));
+        CPPUNIT_ASSERT_EQUAL(ptrdiff_t {0}, ranges::distance(json_cfg->keys_with_prefix("b/c/")));
+    }
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_subtree_and_array_size() {
+    json_cfg->load("utest.json");
+    vector<string> values;
+    for(const CfgEntry& e : json_cfg->subtree("detail/alias")) {
+        values.push_back(string {e.key} + "=" + json_cfg->get_as_str(e.key));
+    }
+    CPPUNIT_ASSERT((vector<string> {"/detail/alias/0=cpp", "/detail/alias/1=c++", "/detail/alias/2=C++"}) == values);
+    auto id = json_cfg->subtree("id").begin();
+    CPPUNIT_ASSERT_EQUAL(string_view {"/id"}, (*id).key);
+    CPPUNIT_ASSERT_EQUAL(int64_t {32}, (*id).value.i);
+    CPPUNIT_ASSERT(++id == default_sentinel);
+    CPPUNIT_ASSERT(json_cfg->subtree("nope").begin() == default_sentinel);
+
+    CPPUNIT_ASSERT_EQUAL(size_t {3}, json_cfg->array_size("tags"));
+    CPPUNIT_ASSERT_EQUAL(size_t {2}, json_cfg->array_size("detail/appendix/platform_ids"));
+    CPPUNIT_ASSERT_THROW(json_cfg->array_size("id"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->array_size("nope"), TanuCfgException);
+
+    // the subtree of a repeated member name is the last value's
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "dup_tmp.json";
+    ofstream(fpath) << R"({"a":{"x":1},"a":{"y":2},"b":{"c":[1,2]},"b":{"c":5}})";
+    for(const bool lazy : {false, true}) {
+        json_cfg->set_lazy_sections(lazy);
+        json_cfg->load("dup_tmp.json");
+        values.clear();
+        for(const CfgEntry& e : json_cfg->subtree("")) {
+            values.push_back(string {e.key} + "=" + to_string(e.value.i));
+        }
+        CPPUNIT_ASSERT((vector<string> {"/a/y=2", "/b/c=5"}) == values);
+        CPPUNIT_ASSERT_EQUAL(ptrdiff_t {1}, ranges::distance(json_cfg->subtree("a")));
+        CPPUNIT_ASSERT(json_cfg->subtree("a/x").begin() == default_sentinel);
+        CPPUNIT_ASSERT(json_cfg->subtree("b/c/0").begin() == default_sentinel);
+        CPPUNIT_ASSERT_THROW(json_cfg->array_size("b/c"), TanuCfgException);
+    }
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_lazy_sections_materialize_on_demand() {
+    json_cfg->set_lazy_sections(true);
+    json_cfg->load("utest.json");
+    const CfgMemoryUsage before = json_cfg->memory_usage();
+    CPPUNIT_ASSERT_EQUAL(size_t {0}, before.values);
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->get_as_int("/id"));
+    CPPUNIT_ASSERT_EQUAL(string {"c++"}, json_cfg->get_as_str("detail/lang"));
+    CPPUNIT_ASSERT_EQUAL(string {"c++"}, json_cfg->get_as_str("detail/lang"));
+    CPPUNIT_ASSERT_EQUAL(string {"VECTOR"}, json_cfg->get_as_str("detail/appendix/special_feature"));
+    CPPUNIT_ASSERT((vector<int> {1, 0}) == json_cfg->get_as_int_vec("detail/appendix/platform_ids"));
+    CPPUNIT_ASSERT(json_cfg->memory_usage().values > 0);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("detail/nope"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("nope"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(7, json_cfg->get_or("nope/deeper", 7));
+
+    // whole-document views see every key
+    CPPUNIT_ASSERT_EQUAL(ptrdiff_t {20}, ranges::distance(json_cfg->keys_with_prefix("")));
+}
+
+void JSONCfgTestSuite::test_lazy_section_errors_deferred() {
+    json_cfg->set_lazy_sections(true);
+    json_cfg->load("lazy_broken.json");
+    CPPUNIT_ASSERT_EQUAL(1, json_cfg->get_as_int("good/a"));
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("bad/x"), TanuCfgException);
+    CPPUNIT_ASSERT(CfgErrc::Malformed == json_cfg->try_get_as_int("bad/x").error().code);
+    CPPUNIT_ASSERT_EQUAL(1, json_cfg->get_as_int("good/a"));
+
+    json_cfg->set_lazy_sections(false);
+    CPPUNIT_ASSERT_THROW(json_cfg->load("lazy_broken.json"), TanuCfgException);
+}
+
+void JSONCfgTestSuite::test_load_async() {
+    future<void> loading = json_cfg->load_async("utest.json");
+    loading.get();
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->get_as_int("id"));
+
+    future<void> broken = json_cfg->load_async("broken.json");
+    CPPUNIT_ASSERT_THROW(broken.get(), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(32, json_cfg->get_as_int("id"));
+}
+
+void JSONCfgTestSuite::test_load_all_reports_per_file_errors() {
+    const vector<CfgLoadRequest> requests {
+        {"cpptanu_cfg_utest", "tanu_cfg", "utest.json"},
+        {"cpptanu_cfg_utest", "tanu_cfg", "broken.json"},
+        {"cpptanu_cfg_utest", "tanu_cfg", "missing.json"},
+        {"cpptanu_cfg_utest", "tanu_cfg", "utest_host.json"}
+    };
+    vector<CfgLoadResult> results = cfg_load_all(requests, 2);
+    CPPUNIT_ASSERT_EQUAL(size_t {4}, results.size());
+    CPPUNIT_ASSERT(results[0].ok());
+    CPPUNIT_ASSERT_EQUAL(string {"tako"}, results[0].config->get_as_str("name"));
+    CPPUNIT_ASSERT(!results[1].ok());
+    CPPUNIT_ASSERT_EQUAL(string {"Json file loading/parsing failed"}, *results[1].error);
+    CPPUNIT_ASSERT(!results[2].ok());
+    CPPUNIT_ASSERT(results[2].error->ends_with("does not exist"));
+    CPPUNIT_ASSERT(results[3].ok());
+    CPPUNIT_ASSERT(results[3].config->version() > 0);
+}
+
+void JSONCfgTestSuite::test_registry_shares_snapshots() {
+    CfgRegistry& registry = CfgRegistry::instance();
+    JSONConfig other {"cpptanu_cfg_utest", "tanu_cfg"};
+    JSONConfig unshared {"cpptanu_cfg_utest", "tanu_cfg"};
+    json_cfg->set_shared_registry(true);
+    other.set_shared_registry(true);
+
+    const uint64_t loads = registry.load_count();
+    json_cfg->load("utest.json");
+    other.load("./utest.json");
+    unshared.load("utest.json");
+    CPPUNIT_ASSERT_EQUAL(loads + 1, registry.load_count());
+    CPPUNIT_ASSERT(json_cfg->snapshot() == other.snapshot());
+    CPPUNIT_ASSERT(json_cfg->snapshot() != unshared.snapshot());
+    CPPUNIT_ASSERT_EQUAL(32, other.get_as_int("id"));
+
+    // a different load mode gets a snapshot of its own
+    other.set_lazy_sections(true);
+    other.load("utest.json");
+    CPPUNIT_ASSERT_EQUAL(loads + 2, registry.load_count());
+    CPPUNIT_ASSERT(json_cfg->snapshot() != other.snapshot());
+}
+
+void JSONCfgTestSuite::test_registry_single_flight_and_reload() {
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "registry_tmp.json";
+    ofstream(fpath) << R"({"a": 1})";
+    CfgRegistry& registry = CfgRegistry::instance();
+    const uint64_t loads = registry.load_count();
+
+    vector<unique_ptr<JSONConfig>> cfgs;
+    for(int i = 0; i < 8; i++) {
+        cfgs.push_back(make_unique<JSONConfig>("cpptanu_cfg_utest", "tanu_cfg"));
+        cfgs.back()->set_shared_registry(true);
+    }
+    vector<thread> loaders;
+    for(auto& cfg : cfgs) {
+        loaders.emplace_back([&cfg] { cfg->load("registry_tmp.json"); });
+    }
+    for(thread& t : loaders) {
+        t.join();
+    }
+    CPPUNIT_ASSERT_EQUAL(loads + 1, registry.load_count());
+    for(auto& cfg : cfgs) {
+        CPPUNIT_ASSERT(cfg->snapshot() == cfgs[0]->snapshot());
+    }
+
+    // a rewritten file is a new identity
+    ofstream(fpath) << R"({"a": 22})";
+    cfgs[1]->load("registry_tmp.json");
+    CPPUNIT_ASSERT_EQUAL(loads + 2, registry.load_count());
+    CPPUNIT_ASSERT_EQUAL(22, cfgs[1]->get_as_int("a"));
+    CPPUNIT_ASSERT_EQUAL(1, cfgs[0]->get_as_int("a"));
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_load_binary_formats() {
+    const auto dir = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg";
+    json_cfg->load("utest.json");
+    const string expected = *json_cfg->dump_flattened_view();
+    const json doc = json::parse(ifstream(dir / "utest.json"));
+    for(const auto& [format, file_name] : {pair {CfgFormat::Cbor, "utest.cbor"}, pair {CfgFormat::MsgPack, "utest.msgpack"}, pair {CfgFormat::Bson, "utest.bson"}}) {
+        const vector<uint8_t> bytes = cfg_encode(doc, format);
+        ofstream(dir / file_name, ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        JSONConfig cfg {"cpptanu_cfg_utest", "tanu_cfg"};
+        cfg.load(file_name);
+        CPPUNIT_ASSERT_EQUAL(expected, *cfg.dump_flattened_view());
+        CPPUNIT_ASSERT_EQUAL(string {"VECTOR"}, cfg.get_as_str("detail/appendix/special_feature"));
+        CPPUNIT_ASSERT((vector<double> {210.45, 18.10, 395.45}) == cfg.get_as_double_vec("detail/appendix/feat_ids"));
+        filesystem::remove(dir / file_name);
+    }
+
+    // truncated input fails like broken json
+    const vector<uint8_t> bytes = cfg_encode(doc, CfgFormat::Cbor);
+    ofstream(dir / "broken.cbor", ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size() / 2);
+    CPPUNIT_ASSERT_THROW(json_cfg->load("broken.cbor"), TanuCfgException);
+    filesystem::remove(dir / "broken.cbor");
+}
+
+void JSONCfgTestSuite::test_detect_format_by_magic() {
+    const json doc = {{"a", 1}, {"b", {1, 2}}};
+    auto detect = [](const vector<uint8_t>& bytes) {
+        return cfg_detect_format("cfg.bin", string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    };
+    CPPUNIT_ASSERT(CfgFormat::Cbor == detect(cfg_encode(doc, CfgFormat::Cbor)));
+    CPPUNIT_ASSERT(CfgFormat::MsgPack == detect(cfg_encode(doc, CfgFormat::MsgPack)));
+    CPPUNIT_ASSERT(CfgFormat::Bson == detect(cfg_encode(doc, CfgFormat::Bson)));
+    CPPUNIT_ASSERT(CfgFormat::Json == detect(cfg_encode(doc, CfgFormat::Json)));
+    CPPUNIT_ASSERT(CfgFormat::Cbor == cfg_detect_format("cfg.cbor", "{}"));
+    CPPUNIT_ASSERT(CfgFormat::Json == cfg_detect_format("cfg.json", "\xa1"));
+
+    // a self-described cbor file without a telling name still loads
+    vector<uint8_t> tagged {0xd9, 0xd9, 0xf7};
+    const vector<uint8_t> body = cfg_encode(doc, CfgFormat::Cbor);
+    tagged.insert(tagged.end(), body.begin(), body.end());
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "tagged.cfg";
+    ofstream(fpath, ios::binary).write(reinterpret_cast<const char*>(tagged.data()), tagged.size());
+    json_cfg->load("tagged.cfg");
+    CPPUNIT_ASSERT_EQUAL(2, json_cfg->get_as_int("b/1"));
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_subscribers_get_prefix_diffs() {
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "notify_tmp.json";
+    ofstream(fpath) << R"({"a": {"x": 1, "y": 2}, "b": [1, 2], "c": "s"})";
+    json_cfg->load("notify_tmp.json");
+
+    mutex mtx;
+    vector<CfgDiff> under_a, everything;
+    json_cfg->subscribe("a", [&](const CfgDiff& d) {
+        lock_guard<mutex> lock(mtx);
+        under_a.push_back(d);
+    });
+    json_cfg->subscribe("", [&](const CfgDiff& d) {
+        lock_guard<mutex> lock(mtx);
+        everything.push_back(d);
+    });
+
+    ofstream(fpath) << R"({"a": {"x": 1, "y": 3, "z": 4}, "c": "s", "d": null})";
+    json_cfg->load("notify_tmp.json");
+    json_cfg->flush_notifications();
+    {
+        lock_guard<mutex> lock(mtx);
+        CPPUNIT_ASSERT_EQUAL(size_t {1}, under_a.size());
+        CPPUNIT_ASSERT((vector<string> {"/a/z"}) == under_a[0].added);
+        CPPUNIT_ASSERT((vector<string> {"/a/y"}) == under_a[0].changed);
+        CPPUNIT_ASSERT(under_a[0].removed.empty());
+        CPPUNIT_ASSERT_EQUAL(size_t {1}, everything.size());
+        CPPUNIT_ASSERT((vector<string> {"/a/z", "/d"}) == everything[0].added);
+        CPPUNIT_ASSERT((vector<string> {"/b/0", "/b/1"}) == everything[0].removed);
+        CPPUNIT_ASSERT_EQUAL(uint64_t {1}, everything[0].from_version);
+        CPPUNIT_ASSERT_EQUAL(uint64_t {2}, everything[0].to_version);
+    }
+
+    // an identical reload or one outside a subscriber's prefix is silent
+    ofstream(fpath) << R"({"a": {"x": 1, "y": 3, "z": 4}, "c": "t", "d": null})";
+    json_cfg->load("notify_tmp.json");
+    json_cfg->load("notify_tmp.json");
+    json_cfg->flush_notifications();
+    {
+        lock_guard<mutex> lock(mtx);
+        CPPUNIT_ASSERT_EQUAL(size_t {1}, under_a.size());
+        CPPUNIT_ASSERT(everything.size() >= 2);
+        CPPUNIT_ASSERT((vector<string> {"/c"}) == everything[1].changed);
+    }
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_diff_and_unsubscribe() {
+    const CfgIndex before = CfgIndex::parse(R"({"a": 1, "b": {"c": [], "d": 1.5}, "e": "x"})");
+    const CfgIndex after = CfgIndex::parse(R"({"a": {"n": true}, "b": {"c": [], "d": 1.5}, "e": "y"})");
+    const CfgDiff diff = cfg_diff(before, after);
+    CPPUNIT_ASSERT((vector<string> {"/a"}) == diff.removed);
+    CPPUNIT_ASSERT((vector<string> {"/a/n"}) == diff.added);
+    CPPUNIT_ASSERT((vector<string> {"/e"}) == diff.changed);
+    CPPUNIT_ASSERT(diff.under("b").empty());
+    CPPUNIT_ASSERT(cfg_diff(after, after).empty());
+
+    json_cfg->load("utest.json");
+    atomic<int> calls {0};
+    const uint64_t id = json_cfg->subscribe("", [&](const CfgDiff&) { calls++; });
+    json_cfg->load("utest_host.json");
+    json_cfg->flush_notifications();
+    CPPUNIT_ASSERT_EQUAL(1, calls.load());
+    json_cfg->unsubscribe(id);
+    json_cfg->load("utest.json");
+    json_cfg->flush_notifications();
+    CPPUNIT_ASSERT_EQUAL(1, calls.load());
+}
+
+void JSONCfgTestSuite::test_str_view_shares_interned_bytes() {
+    json_cfg->load("utest.json");
+    const string_view lang = json_cfg->get_as_str_view("detail/lang");
+    CPPUNIT_ASSERT_EQUAL(string_view {"c++"}, lang);
+    // "c++" is stored once for detail/lang and detail/alias/1
+    CPPUNIT_ASSERT(lang.data() == json_cfg->get_as_str_span("detail/alias")[1].data());
+    CPPUNIT_ASSERT(lang.data() == json_cfg->get_as_str_view("/detail/alias/1").data());
+    CPPUNIT_ASSERT(lang.data() != json_cfg->get_as_str_view("detail/alias/2").data());
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_str_view("id"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_str_view("nope"), TanuCfgException);
+}
+
+void JSONCfgTestSuite::test_str_view_outlives_reload_with_snapshot() {
+    json_cfg->load("utest.json");
+    const shared_ptr<const CfgSnapshot> pinned = json_cfg->snapshot();
+    const string_view name = json_cfg->get_as_str_view("name");
+    json_cfg->load("utest_host.json");
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT(pinned != json_cfg->snapshot());
+    CPPUNIT_ASSERT_EQUAL(string_view {"tako"}, name);
+    CPPUNIT_ASSERT_EQUAL(string {"tako"}, json_cfg->get_as_str("name"));
+}
+
+void JSONCfgTestSuite::test_wide_scalar_getters() {
+    json_cfg->load("numeric.json");
+    CPPUNIT_ASSERT_EQUAL(int64_t {9007199254740993}, json_cfg->get_as_int64("big_id"));
+    CPPUNIT_ASSERT_EQUAL(int64_t {-5000000000}, json_cfg->get_as_int64("negative"));
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int64("huge"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(UINT64_MAX, json_cfg->get_as_uint64("huge"));
+    CPPUNIT_ASSERT_EQUAL(uint64_t {9007199254740993}, json_cfg->get_as_uint64("big_id"));
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_uint64("negative"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(0.1f, json_cfg->get_as_float("ratio"));
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_float("big_id"), TanuCfgException);
+    CPPUNIT_ASSERT(json_cfg->get_as_bool("enabled"));
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_bool("ratio"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int64("nope"), TanuCfgException);
+}
+
+void JSONCfgTestSuite::test_copy_as_matches_scalar_conversion() {
+    json_cfg->load("numeric.json");
+    const vector<double> features = json_cfg->get_as_double_vec("features");
+    vector<float> out(features.size() + 3, -1.0f);
+    CPPUNIT_ASSERT_EQUAL(features.size(), json_cfg->copy_as<float>("features", out));
+    for(size_t i = 0; i < features.size(); i++) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<float>(features[i]), out[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL(-1.0f, out[features.size()]);
+    vector<float> small(4);
+    CPPUNIT_ASSERT_THROW(json_cfg->copy_as<float>("features", span<float>(small)), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->copy_as<int64_t>("features", span<int64_t>()), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->copy_as<float>("names", span<float>(out)), TanuCfgException);
+
+    const CfgAlignedArray<double> ids = json_cfg->copy_as_aligned<double>("ids");
+    CPPUNIT_ASSERT_EQUAL(size_t {9}, ids.size());
+    CPPUNIT_ASSERT_EQUAL(uintptr_t {0}, reinterpret_cast<uintptr_t>(ids.data()) % 64);
+    CPPUNIT_ASSERT_EQUAL(static_cast<double>(9007199254740993), ids[3]);
+    CPPUNIT_ASSERT_EQUAL(-2.0, ids[1]);
+    const CfgAlignedArray<int64_t> raw = json_cfg->copy_as_aligned<int64_t>("ids", 128);
+    CPPUNIT_ASSERT_EQUAL(int64_t {9007199254740993}, raw[3]);
+
+    // every kernel level the cpu has agrees with static_cast, tails included
+    vector<double> doubles;
+    vector<int64_t> ints;
+    for(int i = 0; i < 1003; i++) {
+        doubles.push_back((i - 500) * 1234.5678901 + 1e-9 * i);
+        ints.push_back((int64_t {i} - 500) * 987654321987LL + i);
+    }
+    for(int l = 0; l <= static_cast<int>(cfg_simd_level()); l++) {
+        const CfgSimd level = static_cast<CfgSimd>(l);
+        vector<float> f(doubles.size());
+        vector<double> d(ints.size());
+        vector<float> fi(ints.size());
+        cfg_convert(doubles, f.data(), level);
+        cfg_convert(ints, d.data(), level);
+        cfg_convert(ints, fi.data(), level);
+        for(size_t i = 0; i < doubles.size(); i++) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<float>(doubles[i]), f[i]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<double>(ints[i]), d[i]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<float>(ints[i]), fi[i]);
+        }
+    }
+}
+
+void JSONCfgTestSuite::test_schema_rejects_nonconforming_load() {
+    json_cfg->load_schema("schema_app.schema.json");
+    json_cfg->load("schema_app.json");
+    CPPUNIT_ASSERT_EQUAL(8080, json_cfg->get_as_int("port"));
+
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "schema_tmp.json";
+    ofstream(fpath) << R"({"name": 7, "port": 70000, "ratio": 1, "debug": false, "db": {"host": "h"},
+        "weights": [], "backends": [{"host": "a", "port": 0}, {"port": 1}]})";
+    try {
+        json_cfg->load("schema_tmp.json");
+        CPPUNIT_FAIL("a config violating the schema was loaded");
+    } catch(const TanuCfgException& ex) {
+        const string reason = ex.what();
+        for(const char* expected : {"/name: unexpected integer", "/port: 70000 is above the maximum 65535",
+            "/ratio: 1 is above the maximum 1", "/db/pool: missing required key", "/weights: 0 items, expected at least 1",
+            "/backends/0/port: 0 is below the minimum 1", "/backends/1/host: missing required key"}) {
+            CPPUNIT_ASSERT_MESSAGE(reason, reason.find(expected) != string::npos);
+        }
+    }
+    // the conforming version stays live
+    CPPUNIT_ASSERT_EQUAL(8080, json_cfg->get_as_int("port"));
+    filesystem::remove(fpath);
+
+    CPPUNIT_ASSERT_THROW(CfgSchema::compile(json::parse(R"({"type": "decimal"})")), runtime_error);
+    CPPUNIT_ASSERT_THROW(CfgSchema::compile(json::parse(R"({"properties": {"a": {"minimum": "0"}}})")), runtime_error);
+    CPPUNIT_ASSERT_THROW(json_cfg->load_schema("lazy_broken.json"), TanuCfgException);
+}
+
+void JSONCfgTestSuite::test_schema_unchecked_getters() {
+    json_cfg->set_lazy_sections(true);
+    json_cfg->load_schema("schema_app.schema.json");
+    json_cfg->load("schema_app.json");
+    CPPUNIT_ASSERT_EQUAL(int64_t {8080}, json_cfg->get_unchecked<int64_t>("port"));
+    CPPUNIT_ASSERT_EQUAL(int64_t {16}, json_cfg->get_unchecked<int64_t>("/db/pool"));
+    CPPUNIT_ASSERT_EQUAL(0.25, json_cfg->get_unchecked<double>("ratio"));
+    CPPUNIT_ASSERT_EQUAL(8080.0, json_cfg->get_unchecked<double>("port"));
+    CPPUNIT_ASSERT(!json_cfg->get_unchecked<bool>("debug"));
+    CPPUNIT_ASSERT(json_cfg->get_unchecked<string_view>("db/host") == "localhost");
+
+    const CfgSchema schema = CfgSchema::compile(json::parse(ifstream(filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "schema_app.schema.json")));
+    CPPUNIT_ASSERT(schema.guarantees("db/pool", SchemaInteger));
+    CPPUNIT_ASSERT(schema.guarantees("ratio", SchemaInteger | SchemaDouble));
+    CPPUNIT_ASSERT(!schema.guarantees("ratio", SchemaDouble));
+    // optional keys and anything under an array are never guaranteed
+    CPPUNIT_ASSERT(!schema.guarantees("weights", SchemaArray));
+    CPPUNIT_ASSERT(!schema.guarantees("backends/0/port", SchemaInteger));
+    CPPUNIT_ASSERT(!schema.guarantees("db/user", SchemaAny));
+}
+
+void JSONCfgTestSuite::test_stream_dump_matches_string_dumps() {
+    CPPUNIT_ASSERT(!json_cfg->dump(cfg_ostream_sink(cout)));
+    json_cfg->load("schema_app.json");
+    ostringstream compact;
+    CPPUNIT_ASSERT(json_cfg->dump(compact));
+    CPPUNIT_ASSERT(json::parse(compact.str()) == json::parse(*json_cfg->dump_cfg()));
+    ostringstream pretty;
+    CPPUNIT_ASSERT(json_cfg->dump(pretty, CfgDumpOptions {.indent = 4}));
+    CPPUNIT_ASSERT(json::parse(pretty.str()) == json::parse(compact.str()));
+    CPPUNIT_ASSERT(pretty.str().starts_with("{\n    \"name\": \"tanu\",\n"));
+    ostringstream flat;
+    CPPUNIT_ASSERT(json_cfg->dump(flat, CfgDumpOptions {.flattened = true}));
+    CPPUNIT_ASSERT(json::parse(flat.str()) == json::parse(*json_cfg->dump_flattened_view()));
+
+    // small chunks concatenate to the same text
+    vector<string> chunks;
+    CPPUNIT_ASSERT(json_cfg->dump([&chunks](string_view chunk) { chunks.emplace_back(chunk); }, CfgDumpOptions {.chunk_size = 16}));
+    CPPUNIT_ASSERT(chunks.size() > 4);
+    string joined;
+    for(const string& chunk : chunks) {
+        CPPUNIT_ASSERT(chunk.size() < 16 + 16);
+        joined += chunk;
+    }
+    CPPUNIT_ASSERT_EQUAL(compact.str(), joined);
+
+    // names and strings are escaped, doubles stay doubles
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "dump_tmp.json";
+    ofstream(fpath) << R"({"a/b": "x\"y\n\u0001", "t~": [1.0, 2, {}, 0.5, -3e300]})";
+    json_cfg->load("dump_tmp.json");
+    ostringstream escaped;
+    CPPUNIT_ASSERT(json_cfg->dump(escaped));
+    CPPUNIT_ASSERT_EQUAL(string {R"({"a/b":"x\"y\n\u0001","t~":[1.0,2,{},0.5,-3e+300]})"}, escaped.str());
+    ostringstream escaped_flat;
+    CPPUNIT_ASSERT(json_cfg->dump(escaped_flat, CfgDumpOptions {.flattened = true}));
+    CPPUNIT_ASSERT_EQUAL(string {R"({"/a~1b":"x\"y\n\u0001","/t~0/0":1.0,"/t~0/1":2,"/t~0/2":null,"/t~0/3":0.5,"/t~0/4":-3e+300})"}, escaped_flat.str());
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_stream_dump_prefix_depth_and_fd() {
+    json_cfg->set_lazy_sections(true);
+    json_cfg->load("schema_app.json");
+    ostringstream db;
+    CPPUNIT_ASSERT(json_cfg->dump(db, CfgDumpOptions {.prefix = "db"}));
+    CPPUNIT_ASSERT_EQUAL(string {R"({"host":"localhost","pool":16})"}, db.str());
+    ostringstream backend;
+    CPPUNIT_ASSERT(json_cfg->dump(backend, CfgDumpOptions {.prefix = "/backends/1", .flattened = true}));
+    CPPUNIT_ASSERT_EQUAL(string {R"({"/backends/1/host":"b","/backends/1/port":9002})"}, backend.str());
+    ostringstream missing;
+    CPPUNIT_ASSERT(!json_cfg->dump(missing, CfgDumpOptions {.prefix = "db/user"}));
+    CPPUNIT_ASSERT(missing.str().empty());
+
+    ostringstream shallow;
+    CPPUNIT_ASSERT(json_cfg->dump(shallow, CfgDumpOptions {.max_depth = 1}));
+    CPPUNIT_ASSERT_EQUAL(string {R"({"name":"tanu","port":8080,"ratio":0.25,"debug":false,"db":{},"weights":[],"backends":[]})"}, shallow.str());
+    ostringstream shallow_flat;
+    CPPUNIT_ASSERT(json_cfg->dump(shallow_flat, CfgDumpOptions {.prefix = "backends", .max_depth = 1, .flattened = true}));
+    CPPUNIT_ASSERT_EQUAL(string {"{}"}, shallow_flat.str());
+    ostringstream pretty;
+    CPPUNIT_ASSERT(json_cfg->dump(pretty, CfgDumpOptions {.prefix = "weights", .indent = 2}));
+    CPPUNIT_ASSERT_EQUAL(string {"[\n  0.5,\n  1.5,\n  2.5\n]"}, pretty.str());
+
+    const auto fpath = filesystem::temp_directory_path() / "cpptanu_cfg_dump_fd.json";
+    const int fd = open(fpath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    CPPUNIT_ASSERT(fd >= 0);
+    CPPUNIT_ASSERT(json_cfg->dump(fd, CfgDumpOptions {.indent = 1, .chunk_size = 8}));
+    close(fd);
+    CPPUNIT_ASSERT(json::parse(ifstream(fpath)) == json::parse(*json_cfg->dump_cfg()));
+    filesystem::remove(fpath);
+    CPPUNIT_ASSERT_THROW(cfg_fd_sink(-1)("x"), system_error);
+}
+
+void JSONCfgTestSuite::test_hashed_key_literals_match_string_getters() {
+    // hashed while compiling, with or without the leading '/'
+    static_assert(("detail/lang"_cfgkey).hash() == cfg_key_hash("/detail/lang"));
+    static_assert(("/detail/lang"_cfgkey).hash() == ("detail/lang"_cfgkey).hash());
+    static_assert(("detail/appendix"_cfgkey).path() == "detail/appendix");
+    // "detail/appendix/"_cfgkey doesn't compile: get_as_*("detail/appendix/")
+    // finds nothing, so the literal can't quietly mean something else
+
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT_EQUAL(json_cfg->get_as_int("id"), json_cfg->get_as_int("id"_cfgkey));
+    CPPUNIT_ASSERT_EQUAL(json_cfg->get_as_double("version"), json_cfg->get_as_double("/version"_cfgkey));
+    CPPUNIT_ASSERT_EQUAL(json_cfg->get_as_str("detail/lang"), json_cfg->get_as_str("detail/lang"_cfgkey));
+    CPPUNIT_ASSERT(json_cfg->get_as_str_view("detail/appendix/special_feature"_cfgkey) == "VECTOR");
+    CPPUNIT_ASSERT(json_cfg->get_as_int_vec("detail/appendix/platform_ids") == json_cfg->get_as_int_vec("detail/appendix/platform_ids"_cfgkey));
+    CPPUNIT_ASSERT(json_cfg->get_as_str_vec("tags") == json_cfg->get_as_str_vec("tags"_cfgkey));
+    CPPUNIT_ASSERT(json_cfg->get_as_double_vec("detail/appendix/feat_ids") == json_cfg->get_as_double_vec("detail/appendix/feat_ids"_cfgkey));
+    CPPUNIT_ASSERT_EQUAL(size_t {3}, json_cfg->get_as_double_span("detail/appendix/feat_ids"_cfgkey).size());
+    CPPUNIT_ASSERT_EQUAL(int64_t {10}, json_cfg->get_as_int64("detail/lang-version"_cfgkey));
+    CPPUNIT_ASSERT_EQUAL(int64_t {1}, json_cfg->get_as_int_span("detail/appendix/platform_ids"_cfgkey)[0]);
+    CPPUNIT_ASSERT(json_cfg->get_as_str_span("detail/alias"_cfgkey)[2] == "C++");
+    CPPUNIT_ASSERT_EQUAL(32, *json_cfg->try_get_as_int("id"_cfgkey));
+    CPPUNIT_ASSERT(*json_cfg->try_get_as_str("detail/lang"_cfgkey) == "c++");
+    CPPUNIT_ASSERT_EQUAL(0.2864, *json_cfg->try_get_as_double("detail/lang-patch"_cfgkey));
+}
+
+void JSONCfgTestSuite::test_hashed_key_errors_and_lazy_sections() {
+    json_cfg->set_lazy_sections(true);
+    json_cfg->load("utest.json");
+    CPPUNIT_ASSERT_EQUAL(string {"VECTOR"}, json_cfg->get_as_str("detail/appendix/special_feature"_cfgkey));
+    try {
+        json_cfg->get_as_int("detail/appendix/platform"_cfgkey);
+        CPPUNIT_FAIL("a string array was read as int");
+    } catch(const TanuCfgException& ex) {
+        CPPUNIT_ASSERT_EQUAL(string {"key '/detail/appendix/platform' not found"}, string {ex.what()}.substr(string {ex.what()}.find("key")));
+    }
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_double("name"_cfgkey), TanuCfgException);
+    const auto missing = json_cfg->try_get_as_int_span("detail/nope"_cfgkey);
+    CPPUNIT_ASSERT(!missing && missing.error().code == CfgErrc::NotFound);
+    CPPUNIT_ASSERT_EQUAL(string {"key '/detail/nope' not found"}, missing.error().message());
+
+    // keys built at run time take the same path
+    const string built = string {"detail/"} + "lang";
+    CPPUNIT_ASSERT_EQUAL(string {"c++"}, json_cfg->get_as_str(CfgHashedKey(built)));
+    CPPUNIT_ASSERT_EQUAL(CfgHashedKey(built).hash(), ("detail/lang"_cfgkey).hash());
+}
+
+void JSONCfgTestSuite::test_lazy_snapshot_survives_in_place_rewrite() {
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "lazy_tmp.json";
+    const string text = R"({"a": {"x": 1, "y": 2}, "b": {"y": 2, "pad": ")" + string(1 << 16, 'p')
+        + R"("}, "a": {"x": 3}, "c": {"v": 4}, "c": 5, "d": 6, "d": {"w": 7}})";
+    ofstream(fpath) << text;
+    json_cfg->set_lazy_sections(true);
+    json_cfg->load("lazy_tmp.json");
+
+    // repeated top-level names answer like a full parse of the same file
+    JSONConfig full {"cpptanu_cfg_utest", "tanu_cfg"};
+    full.load("lazy_tmp.json");
+    CPPUNIT_ASSERT_EQUAL(3, json_cfg->get_as_int("a/x"));
+    CPPUNIT_ASSERT_THROW(full.get_as_int("a/y"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("a/y"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(5, json_cfg->get_as_int("c"));
+    CPPUNIT_ASSERT_EQUAL(7, json_cfg->get_as_int("d/w"));
+    CPPUNIT_ASSERT_THROW(full.get_as_int("d"), TanuCfgException);
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int("d"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(*full.dump_cfg(), *json_cfg->dump_cfg());
+
+    // truncated and rewritten in place, as editors and the watcher's
+    // IN_CLOSE_WRITE see it; /b is not parsed yet and still reads the old bytes
+    json_cfg->load("lazy_tmp.json");
+    ofstream(fpath, ios::trunc) << R"({"b": 1})";
+    CPPUNIT_ASSERT_EQUAL(2, json_cfg->get_as_int("b/y"));
+    filesystem::remove(fpath);
+}
+
+void JSONCfgTestSuite::test_spans_survive_reads_of_other_configs() {
+    json_cfg->load("utest.json");
+    const span<const double> fids = json_cfg->get_as_double_span("detail/appendix/feat_ids");
+    const span<const string_view> tags = json_cfg->get_as_str_span("tags");
+    // a reload publishes a new version, but this thread keeps the one its
+    // spans point into until it reads json_cfg again, however many other
+    // configs it reads meanwhile
+    json_cfg->load("utest.json");
+    vector<unique_ptr<JSONConfig>> cfgs;
+    for(int i = 0; i < 40; ++i) {
+        cfgs.push_back(make_unique<JSONConfig>("cpptanu_cfg_utest", "tanu_cfg"));
+        cfgs.back()->load("utest.json");
+        CPPUNIT_ASSERT_EQUAL(size_t {2}, cfgs.back()->get_as_int_span("detail/appendix/platform_ids").size());
+    }
+    // configs made after others are gone reuse their slots
+    cfgs.erase(cfgs.begin(), cfgs.begin() + 20);
+    for(int i = 0; i < 30; ++i) {
+        cfgs.push_back(make_unique<JSONConfig>("cpptanu_cfg_utest", "tanu_cfg"));
+        cfgs.back()->load("utest.json");
+    }
+    for(const auto& cfg : cfgs) {
+        CPPUNIT_ASSERT_EQUAL(string_view {"neko"}, cfg->get_as_str_span("tags")[0]);
+    }
+    vector<double> expected_fids {210.45, 18.10, 395.45};
+    CPPUNIT_ASSERT(equal(expected_fids.begin(), expected_fids.end(), fids.begin(), fids.end()));
+    CPPUNIT_ASSERT_EQUAL(string_view {"pokora"}, tags[2]);
+    CPPUNIT_ASSERT_EQUAL(395.45, json_cfg->get_as_double_span("detail/appendix/feat_ids")[2]);
+}
+
+void JSONCfgTestSuite::test_untrusted_images_rejected() {
+    const auto image_path = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "untrusted.json.tcfg";
+    const string text = R"({"a": {"b": [1, 2, 3], "c": ["x", "y"]}, "e": "tanu"})";
+    CfgIndex::parse(text).write_image(image_path, CfgImageKey {"untrusted.json", text.size(), 0, cfg_content_hash(text)});
+    auto accept = [](const CfgImageKey&) { return true; };
+    const optional<CfgIndex> index = CfgIndex::open_image(image_path, accept);
+    CPPUNIT_ASSERT(index.has_value());
+    CPPUNIT_ASSERT_EQUAL(string_view {"y"}, index->str_array(*index->find("a/c"))[1]);
+
+    // only images nobody but this user can write are trusted
+    filesystem::permissions(image_path, filesystem::perms::group_write, filesystem::perm_options::add);
+    CPPUNIT_ASSERT(!CfgIndex::open_image(image_path, accept).has_value());
+    filesystem::permissions(image_path, filesystem::perms::group_write, filesystem::perm_options::remove);
+    CPPUNIT_ASSERT(CfgIndex::open_image(image_path, accept).has_value());
+    if(geteuid() == 0 && chown(image_path.c_str(), 65534, 65534) == 0) {
+        CPPUNIT_ASSERT(!CfgIndex::open_image(image_path, accept).has_value());
+        CPPUNIT_ASSERT_EQUAL(0, chown(image_path.c_str(), 0, 0));
+    }
+
+    // sections that don't fit the file turn it away
+    filesystem::resize_file(image_path, filesystem::file_size(image_path) - 64);
+    CPPUNIT_ASSERT(!CfgIndex::open_image(image_path, accept).has_value());
+    filesystem::remove(image_path);
+}
+
+void JSONCfgTestSuite::test_shared_memory_private_to_user() {
+    const auto dir = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg";
+    const auto cfg_path = dir / "shared_private.json";
+    filesystem::copy_file(dir / "utest.json", cfg_path, filesystem::copy_options::overwrite_existing);
+    CfgSharedSegments::unlink(cfg_path);
+
+    json_cfg->set_shared_memory(true);
+    json_cfg->load("shared_private.json");
+    const string control = format("/dev/shm/tanucfg.{:016x}", cfg_content_hash(filesystem::absolute(cfg_path).lexically_normal().string()));
+    const auto owner_only = filesystem::perms::owner_read | filesystem::perms::owner_write;
+    CPPUNIT_ASSERT(filesystem::status(control).permissions() == owner_only);
+    CPPUNIT_ASSERT(filesystem::status(control + ".1").permissions() == owner_only);
+
+    // segments someone else planted are not used; only root can fake one here
+    if(geteuid() == 0 && chown((control + ".1").c_str(), 65534, 65534) == 0) {
+        json_cfg->load("shared_private.json");
+        CPPUNIT_ASSERT_EQUAL(uint64_t {2}, CfgSharedSegments(cfg_path).generation());
+        CPPUNIT_ASSERT_EQUAL(0, chown(control.c_str(), 65534, 65534));
+        CPPUNIT_ASSERT_THROW(CfgSharedSegments {cfg_path}, system_error);
+        ofstream(cfg_path) << R"({"id": 33})";
+        json_cfg->load("shared_private.json");
+        CPPUNIT_ASSERT_EQUAL(33, json_cfg->get_as_int("id"));
+    }
+
+    CfgSharedSegments::unlink(cfg_path);
+    filesystem::remove(cfg_path);
+}
+
+void JSONCfgTestSuite::test_schema_inclusive_and_exclusive_bounds() {
+    // both keywords on one side: whichever is stricter decides
+    const CfgSchema schema = CfgSchema::compile(json::parse(R"({"properties": {
+        "a": {"minimum": 0, "exclusiveMinimum": -5},
+        "b": {"exclusiveMinimum": 0, "minimum": -5},
+        "c": {"maximum": 10, "exclusiveMaximum": 20},
+        "d": {"exclusiveMaximum": 3, "maximum": 10},
+        "e": {"items": {"maximum": 2, "exclusiveMaximum": 4}}}})"));
+    CPPUNIT_ASSERT(schema.validate(CfgIndex::parse(R"({"a": 0, "b": 0.5, "c": 10, "d": 2.5, "e": [1, 2]})")).empty());
+    const vector<string> errors = schema.validate(CfgIndex::parse(R"({"a": -1, "b": 0, "c": 15, "d": 3, "e": [3]})"));
+    CPPUNIT_ASSERT_EQUAL(size_t {5}, errors.size());
+    string joined;
+    for(const string& e : errors) {
+        joined += e + "\n";
+    }
+    for(const char* expected : {"/a: -1 is below the minimum 0", "/b: 0 is below the minimum 0",
+        "/c: 15 is above the maximum 10", "/d: 3 is above the maximum 3"}) {
+        CPPUNIT_ASSERT_MESSAGE(joined, joined.find(expected) != string::npos);
+    }
+}
+
+void JSONCfgTestSuite::test_int_getters_check_range() {
+    json_cfg->set_schema(make_shared<const CfgSchema>(CfgSchema::compile(json::parse(
+        R"({"required": ["huge"], "properties": {"huge": {"type": "integer"}}})"))));
+    json_cfg->load("numeric.json");
+    for(const char* key : {"huge", "big_id", "negative"}) {
+        const auto rez = json_cfg->try_get_as_int(key);
+        CPPUNIT_ASSERT(!rez.has_value());
+        CPPUNIT_ASSERT(CfgErrc::OutOfRange == rez.error().code);
+        CPPUNIT_ASSERT_EQUAL("/" + string {key} + "'s value is out of int range", rez.error().message());
+        CPPUNIT_ASSERT_THROW(json_cfg->get_as_int(string_view {key}), TanuCfgException);
+        CPPUNIT_ASSERT_THROW(json_cfg->resolve<int>(key), TanuCfgException);
+        CPPUNIT_ASSERT_EQUAL(7, json_cfg->get_or(key, 7));
+    }
+    CPPUNIT_ASSERT_THROW(json_cfg->get_as_int_vec("ids"), TanuCfgException);
+    CPPUNIT_ASSERT_EQUAL(INT64_MAX, json_cfg->get_unchecked<int64_t>("huge"));
+}
+
+void JSONCfgTestSuite::test_stream_dump_drops_duplicate_keys() {
+    const auto fpath = filesystem::current_path() / "testdata" / "cpptanu_cfg_utest" / "tanu_cfg" / "dup_tmp.json";
+    ofstream(fpath) << R"({"a":{"x":1},"a":{"y":2},"b":{"c":[1,2]},"b":{"c":5}})";
+    for(const bool lazy : {false, true}) {
+        json_cfg->set_lazy_sections(lazy);
+        json_cfg->load("dup_tmp.json");
+        ostringstream compact;
+        CPPUNIT_ASSERT(json_cfg->dump(compact));
+        CPPUNIT_ASSERT_EQUAL(string {R"({"a":{"y":2},"b":{"c":5}})"}, compact.str());
+        CPPUNIT_ASSERT(json::parse(compact.str()) == json::parse(*json_cfg->dump_cfg()));
+        ostringstream flat;
+        CPPUNIT_ASSERT(json_cfg->dump(flat, CfgDumpOptions {.flattened = true}));
+        CPPUNIT_ASSERT_EQUAL(string {R"({"/a/y":2,"/b/c":5})"}, flat.str());
+        CPPUNIT_ASSERT(json::parse(flat.str()) == json::parse(*json_cfg->dump_flattened_view()));
+    }
+    filesystem::remove(fpath);
+}
 
 CPPUNIT_TEST_SUITE_REGISTRATION(JSONCfgTestSuite);
 